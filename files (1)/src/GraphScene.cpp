@@ -2,12 +2,15 @@
 #include <QGraphicsSceneMouseEvent>
 #include <QInputDialog>
 #include <QMessageBox>
+#include <QTimer>
+#include "items/LevelOfDetail.h"
 
 GraphScene::GraphScene(QObject* parent) 
     : QGraphicsScene(parent), m_mode(ToolMode::Select), m_stateCounter(0), 
-      m_tempStartNode(nullptr), m_tempLine(nullptr)
+      m_tempStartNode(nullptr), m_tempLine(nullptr), m_edgeBatch(nullptr), m_batchEdges(false), m_batchPending(false)
 {
     setSceneRect(0, 0, 2000, 2000);
+    createEdgeBatch();
     // Default alphabet
     m_alphabet = {"a", "b"};
 }
@@ -23,6 +26,7 @@ void GraphScene::setMode(ToolMode mode) {
 }
 
 void GraphScene::setAlphabet(const std::vector<std::string>& alpha) {
+    if (alpha != m_alphabet) record(DFAEdit::AlphabetChanged);
     m_alphabet = alpha;
 }
 
@@ -30,14 +34,16 @@ DFA GraphScene::exportToDFA() const {
     DFA dfa;
     dfa.alphabet = m_alphabet;
     
-    for (auto* item : items()) {
-        if (auto* s = dynamic_cast<StateItem*>(item)) {
+    // Scene order keeps the export stable between runs
+    const QList<QGraphicsItem*> all = items();
+    for (auto* item : all) {
+        if (auto* s = qgraphicsitem_cast<StateItem*>(item)) {
             dfa.addState(s->getId().toStdString(), s->isStart(), s->isAccept(), s->x(), s->y());
         }
     }
     
-    for (auto* item : items()) {
-        if (auto* t = dynamic_cast<TransitionItem*>(item)) {
+    for (auto* item : all) {
+        if (auto* t = qgraphicsitem_cast<TransitionItem*>(item)) {
             QStringList symbols = t->getSymbol().split(',', Qt::SkipEmptyParts);
             for (const auto& sym : symbols) {
                  dfa.addTransition(t->getFrom()->getId().toStdString(), 
@@ -51,6 +57,15 @@ DFA GraphScene::exportToDFA() const {
 
 void GraphScene::loadFromDFA(const DFA& dfa) {
     clear();
+    m_states.clear();
+    m_edges.clear();
+    m_highlighted.clear();
+    m_journal.clear();
+    record(DFAEdit::Reloaded);
+    // clear() deleted the rubber-band line as well
+    m_tempLine = nullptr;
+    m_tempStartNode = nullptr;
+    createEdgeBatch();
     m_alphabet = dfa.alphabet;
     m_stateCounter = 0;
     
@@ -59,7 +74,7 @@ void GraphScene::loadFromDFA(const DFA& dfa) {
     // Load states
     for (const auto& s : dfa.states) {
         StateItem* item = new StateItem(QString::fromStdString(s.id), s.x, s.y, s.isStart, s.isAccept);
-        addItem(item);
+        addState(item);
         nodeMap[s.id] = item;
         
         // Update counter heuristic
@@ -90,72 +105,163 @@ void GraphScene::loadFromDFA(const DFA& dfa) {
         StateItem* src = nodeMap[kv.first.first];
         StateItem* dst = nodeMap[kv.first.second];
         if (src && dst) {
-            TransitionItem* tItem = new TransitionItem(src, dst, QString::fromStdString(kv.second));
-            addItem(tItem);
+            addTransition(new TransitionItem(src, dst, QString::fromStdString(kv.second)));
         }
     }
+    rebuildEdgeBatch();
+    // Grow the canvas to whatever the automaton's layout covers
+    setSceneRect(itemsBoundingRect().adjusted(-100, -100, 100, 100).united(QRectF(0, 0, 2000, 2000)));
 }
 
 void GraphScene::deleteSelected() {
+    // Transitions are not selectable, so the selection is states only
     for (auto* item : selectedItems()) {
-        // If state, remove connected transitions first
-        if (auto* s = dynamic_cast<StateItem*>(item)) {
-            // Find transitions connected to this state
-            // Copy list to avoid iterator invalidation
-            QList<QGraphicsItem*> all = items(); 
-            for (auto* other : all) {
-                if (auto* t = dynamic_cast<TransitionItem*>(other)) {
-                    if (t->getFrom() == s || t->getTo() == s) {
-                        removeItem(t);
-                        delete t;
-                    }
-                }
-            }
-        }
-        removeItem(item);
-        delete item;
+        if (auto* s = qgraphicsitem_cast<StateItem*>(item)) removeState(s);
     }
 }
 
 void GraphScene::setStartSelected() {
     auto sel = selectedItems();
     if (sel.size() != 1) return;
-    if (auto* s = dynamic_cast<StateItem*>(sel.first())) {
+    if (auto* s = qgraphicsitem_cast<StateItem*>(sel.first())) {
         // Unset other starts
-        for (auto* item : items()) {
-            if (auto* other = dynamic_cast<StateItem*>(item)) {
-                other->setStart(false);
-            }
+        for (auto* other : std::as_const(m_states)) {
+            if (other->isStart()) other->setStart(false);
         }
         s->setStart(true);
+        record(DFAEdit::StartChanged, s->getId());
     }
 }
 
 void GraphScene::toggleAcceptSelected() {
     for (auto* item : selectedItems()) {
-        if (auto* s = dynamic_cast<StateItem*>(item)) {
+        if (auto* s = qgraphicsitem_cast<StateItem*>(item)) {
             s->setAccept(!s->isAccept());
+            record(DFAEdit::AcceptChanged, s->getId());
         }
     }
 }
 
 void GraphScene::highlightStates(const std::vector<std::string>& ids, QColor color) {
-    for (auto* item : items()) {
-        if (auto* s = dynamic_cast<StateItem*>(item)) {
-            for (const auto& id : ids) {
-                if (s->getId().toStdString() == id) {
-                    s->setHighlight(color);
-                }
-            }
+    for (const auto& id : ids) {
+        if (StateItem* s = findState(QString::fromStdString(id))) {
+            s->setHighlight(color);
+            m_highlighted.insert(s);
         }
     }
 }
 
 void GraphScene::clearHighlights() {
-    for (auto* item : items()) {
-        if (auto* s = dynamic_cast<StateItem*>(item)) s->clearHighlight();
-        if (auto* t = dynamic_cast<TransitionItem*>(item)) t->clearHighlight();
+    for (auto* s : std::as_const(m_highlighted)) s->clearHighlight();
+    m_highlighted.clear();
+}
+
+const QList<TransitionItem*>& GraphScene::incoming(StateItem* s) const {
+    static const QList<TransitionItem*> none;
+    auto it = m_edges.constFind(s);
+    return it == m_edges.cend() ? none : it->in;
+}
+
+const QList<TransitionItem*>& GraphScene::outgoing(StateItem* s) const {
+    static const QList<TransitionItem*> none;
+    auto it = m_edges.constFind(s);
+    return it == m_edges.cend() ? none : it->out;
+}
+
+void GraphScene::stateMoved(StateItem* s) {
+    auto it = m_edges.constFind(s);
+    if (it == m_edges.cend()) return;
+    for (auto* t : it->out) t->updatePosition();
+    // A self loop is in both lists; one update is enough
+    for (auto* t : it->in) {
+        if (t->getFrom() != s) t->updatePosition();
+    }
+    scheduleEdgeBatch();
+}
+
+void GraphScene::setDetailLevel(qreal scale) {
+    bool batch = scale < LevelOfDetail::Batched;
+    if (batch == m_batchEdges) return;
+    m_batchEdges = batch;
+    for (const Incidence& edges : std::as_const(m_edges)) {
+        for (auto* t : edges.out) t->setVisible(!batch);
     }
+    m_edgeBatch->setVisible(batch);
+    rebuildEdgeBatch();
+}
+
+void GraphScene::createEdgeBatch() {
+    m_edgeBatch = new QGraphicsPathItem();
+    // Cosmetic hairline: one pixel wide at any zoom
+    m_edgeBatch->setPen(QPen(Qt::black, 0));
+    m_edgeBatch->setZValue(0);
+    m_edgeBatch->setVisible(m_batchEdges);
+    addItem(m_edgeBatch);
+}
+
+void GraphScene::scheduleEdgeBatch() {
+    // Dragging or deleting many states rebuilds the path once, not per state
+    if (!m_batchEdges || m_batchPending) return;
+    m_batchPending = true;
+    QTimer::singleShot(0, this, [this] {
+        m_batchPending = false;
+        rebuildEdgeBatch();
+    });
+}
+
+void GraphScene::rebuildEdgeBatch() {
+    if (!m_batchEdges) return;
+    // Centre to centre; self loops are too small to see at this scale
+    QPainterPath path;
+    for (auto it = m_edges.cbegin(); it != m_edges.cend(); ++it) {
+        for (auto* t : it->out) {
+            if (t->getTo() == it.key()) continue;
+            path.moveTo(it.key()->pos());
+            path.lineTo(t->getTo()->pos());
+        }
+    }
+    m_edgeBatch->setPath(path);
+}
+
+void GraphScene::addState(StateItem* s) {
+    addItem(s);
+    m_states.insert(s->getId(), s);
+    m_edges.insert(s, Incidence());
+}
+
+void GraphScene::addTransition(TransitionItem* t) {
+    t->setVisible(!m_batchEdges);
+    addItem(t);
+    m_edges[t->getFrom()].out.append(t);
+    m_edges[t->getTo()].in.append(t);
+}
+
+void GraphScene::removeState(StateItem* s) {
+    // Taken out first, so only the neighbours' lists change below
+    const Incidence edges = m_edges.take(s);
+    for (auto* t : edges.out) {
+        if (t->getTo() != s) m_edges[t->getTo()].in.removeOne(t);
+        removeItem(t);
+        delete t;
+    }
+    for (auto* t : edges.in) {
+        if (t->getFrom() == s) continue; // self loop, deleted above
+        m_edges[t->getFrom()].out.removeOne(t);
+        record(DFAEdit::TransitionsChanged, t->getFrom()->getId());
+        removeItem(t);
+        delete t;
+    }
+    m_states.remove(s->getId());
+    m_highlighted.remove(s);
+    record(DFAEdit::StateRemoved, s->getId());
+    if (m_tempStartNode == s) setMode(m_mode); // drops the half-drawn transition
+    removeItem(s);
+    delete s;
+    scheduleEdgeBatch();
+}
+
+void GraphScene::record(DFAEdit::Kind kind, const QString& id) {
+    m_journal.push_back({kind, id.toStdString()});
 }
 
 void GraphScene::mousePressEvent(QGraphicsSceneMouseEvent *event) {
@@ -165,8 +271,8 @@ void GraphScene::mousePressEvent(QGraphicsSceneMouseEvent *event) {
     if (m_mode == ToolMode::AddState) {
         if (!item) {
             QString id = QString("q%1").arg(m_stateCounter++);
-            StateItem* newItem = new StateItem(id, pos.x(), pos.y(), false, false);
-            addItem(newItem);
+            addState(new StateItem(id, pos.x(), pos.y(), false, false));
+            record(DFAEdit::StateAdded, id);
         }
     } else if (m_mode == ToolMode::AddTransition) {
         if (item) {
@@ -201,14 +307,9 @@ void GraphScene::mouseMoveEvent(QGraphicsSceneMouseEvent *event) {
         m_tempLine->setLine(line);
     }
     
-    // Update transitions for moving nodes
+    // Moving states re-route their own transitions (see stateMoved)
     if (m_mode == ToolMode::Select) {
          QGraphicsScene::mouseMoveEvent(event);
-         for (auto* item : items()) {
-             if (auto* t = dynamic_cast<TransitionItem*>(item)) {
-                 t->updatePosition();
-             }
-         }
     }
 }
 
@@ -220,16 +321,16 @@ void GraphScene::createTransition(StateItem* source, StateItem* target) {
     if (ok && !text.isEmpty()) {
         // Simple check if transition already exists
         // (In a real app, merging logic would be better)
-        TransitionItem* t = new TransitionItem(source, target, text);
-        addItem(t);
+        addTransition(new TransitionItem(source, target, text));
+        record(DFAEdit::TransitionsChanged, source->getId());
+        scheduleEdgeBatch();
     }
 }
 
 StateItem* GraphScene::itemAtPos(const QPointF& pos) {
-    for (auto* item : items()) {
-        if (auto* s = dynamic_cast<StateItem*>(item)) {
-            if (s->contains(s->mapFromScene(pos))) return s;
-        }
+    // Spatial query through the scene's BSP index, topmost first
+    for (auto* item : items(pos)) {
+        if (auto* s = qgraphicsitem_cast<StateItem*>(item)) return s;
     }
     return nullptr;
 }
\ No newline at end of file
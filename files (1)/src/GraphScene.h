@@ -1,9 +1,13 @@
 #pragma once
 #include <QGraphicsScene>
+#include <QHash>
+#include <QList>
+#include <QSet>
 #include <map>
 #include "items/StateItem.h"
 #include "items/TransitionItem.h"
 #include "model/DFA.h"
+#include "algorithms/IncrementalMinimizer.h"
 
 enum class ToolMode {
     Select,
@@ -35,6 +39,23 @@ public:
     void clearHighlights();
     void highlightStates(const std::vector<std::string>& ids, QColor color);
 
+    // Lookups through the scene's own index, no item scans
+    StateItem* findState(const QString& id) const { return m_states.value(id, nullptr); }
+    const QList<TransitionItem*>& incoming(StateItem* s) const;
+    const QList<TransitionItem*>& outgoing(StateItem* s) const;
+
+    // Called by StateItem when it moves; re-routes the incident transitions
+    void stateMoved(StateItem* s);
+
+    // Edits since the last clearJournal(), for IncrementalMinimizer::update.
+    // loadFromDFA() starts a fresh journal holding only Reloaded.
+    const std::vector<DFAEdit>& journal() const { return m_journal; }
+    void clearJournal() { m_journal.clear(); }
+
+    // Current view scale. Below LevelOfDetail::Batched the transitions are
+    // hidden and drawn as one shared path.
+    void setDetailLevel(qreal scale);
+
 signals:
     void message(const QString& msg);
 
@@ -43,6 +64,11 @@ protected:
     void mouseMoveEvent(QGraphicsSceneMouseEvent *event) override;
 
 private:
+    struct Incidence {
+        QList<TransitionItem*> in;
+        QList<TransitionItem*> out;
+    };
+
     ToolMode m_mode;
     std::vector<std::string> m_alphabet;
     int m_stateCounter;
@@ -51,6 +77,25 @@ private:
     StateItem* m_tempStartNode;
     QGraphicsLineItem* m_tempLine;
     
+    // id -> state and state -> incident transitions, kept in step with the items
+    QHash<QString, StateItem*> m_states;
+    QHash<StateItem*, Incidence> m_edges;
+    QSet<StateItem*> m_highlighted;
+    std::vector<DFAEdit> m_journal;
+    void record(DFAEdit::Kind kind, const QString& id = QString());
+    
+    // Zoomed-out stand-in for every TransitionItem
+    QGraphicsPathItem* m_edgeBatch;
+    bool m_batchEdges;
+    bool m_batchPending;
+    void createEdgeBatch();
+    void scheduleEdgeBatch();
+    void rebuildEdgeBatch();
+
+    void addState(StateItem* s);
+    void addTransition(TransitionItem* t);
+    void removeState(StateItem* s);
+    
     void createTransition(StateItem* source, StateItem* target);
     StateItem* itemAtPos(const QPointF& pos);
 };
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "GraphView.h"
+#include "items/LevelOfDetail.h"
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+
+const qreal MIN_SCALE = 0.01;
+const qreal MAX_SCALE = 8.0;
+
+GraphView::GraphView(GraphScene* scene, QWidget* parent)
+    : QGraphicsView(scene, parent), m_graph(scene)
+{
+    setRenderHint(QPainter::Antialiasing);
+    setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+    // Many small items: repaint their bounding rects rather than one union
+    setViewportUpdateMode(QGraphicsView::SmartViewportUpdate);
+    // Every item sets its own pen, brush and font
+    setOptimizationFlags(QGraphicsView::DontSavePainterState | QGraphicsView::DontAdjustForAntialiasing);
+}
+
+void GraphView::zoomBy(qreal factor) {
+    qreal current = transform().m11();
+    qreal target = std::clamp(current * factor, MIN_SCALE, MAX_SCALE);
+    scale(target / current, target / current);
+    applyScale();
+}
+
+void GraphView::zoomToFit() {
+    QRectF bounds = m_graph->itemsBoundingRect();
+    if (bounds.isEmpty()) return;
+    fitInView(bounds.adjusted(-50, -50, 50, 50), Qt::KeepAspectRatio);
+    qreal current = transform().m11();
+    if (current > 1.0) scale(1.0 / current, 1.0 / current);
+    applyScale();
+}
+
+void GraphView::wheelEvent(QWheelEvent* event) {
+    if (!(event->modifiers() & Qt::ControlModifier)) {
+        QGraphicsView::wheelEvent(event);
+        return;
+    }
+    // One notch (120) zooms by about 20%
+    zoomBy(std::pow(1.0015, event->angleDelta().y()));
+    event->accept();
+}
+
+void GraphView::applyScale() {
+    qreal current = transform().m11();
+    // Hairlines at low zoom look the same without antialiasing and draw much faster
+    setRenderHint(QPainter::Antialiasing, current >= LevelOfDetail::Arrows);
+    m_graph->setDetailLevel(current);
+}
\ No newline at end of file
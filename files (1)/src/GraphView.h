@@ -0,0 +1,22 @@
+#pragma once
+#include <QGraphicsView>
+#include "GraphScene.h"
+
+// View for the editor canvas. Ctrl+wheel zooms around the cursor and tells
+// the scene the new scale so large automata drop detail while zoomed out.
+class GraphView : public QGraphicsView {
+    Q_OBJECT
+public:
+    explicit GraphView(GraphScene* scene, QWidget* parent = nullptr);
+
+    void zoomBy(qreal factor);
+    // Fits the whole graph into the window
+    void zoomToFit();
+
+protected:
+    void wheelEvent(QWheelEvent* event) override;
+
+private:
+    GraphScene* m_graph;
+    void applyScale();
+};
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include "LayoutTask.h"
+
+LayoutTask::LayoutTask(const DFA& dfa, const LayoutOptions& options, QObject* parent)
+    : QObject(parent), m_dfa(dfa), m_options(options)
+{
+    m_options.cancel = &m_cancel;
+}
+
+LayoutTask::~LayoutTask() {
+    if (m_thread) {
+        m_cancel = true;
+        m_thread->wait();
+    }
+}
+
+void LayoutTask::start() {
+    m_thread = QThread::create([this] { Layout::apply(m_dfa, m_options); });
+    m_thread->setParent(this);
+    connect(m_thread, &QThread::finished, this, [this] { emit finished(m_cancel); });
+    m_thread->start();
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+#include <QObject>
+#include <QThread>
+#include <atomic>
+#include "layout/Layout.h"
+
+// Lays out a copy of an automaton on its own thread, so placing tens of
+// thousands of states never blocks the window
+class LayoutTask : public QObject {
+    Q_OBJECT
+public:
+    LayoutTask(const DFA& dfa, const LayoutOptions& options, QObject* parent = nullptr);
+    ~LayoutTask() override; // cancels and waits for the thread
+
+    void start();
+    void cancel() { m_cancel = true; }
+
+    // Valid once finished() has been emitted without cancellation
+    const DFA& result() const { return m_dfa; }
+
+signals:
+    void finished(bool cancelled);
+
+private:
+    QThread* m_thread = nullptr;
+    std::atomic<bool> m_cancel{false};
+    DFA m_dfa;
+    LayoutOptions m_options;
+};
\ No newline at end of file
@@ -1,16 +1,20 @@
 #include "MainWindow.h"
-#include "io/DFAJson.h"
+#include "io/DFAJsonStream.h"
+#include "io/DFABinary.h"
+#include "io/Regex.h"
+#include "algorithms/Minimizer.h"
+#include "algorithms/SubsetConstruction.h"
 #include <QToolBar>
 #include <QDockWidget>
 #include <QVBoxLayout>
 #include <QPushButton>
 #include <QFileDialog>
 #include <QMessageBox>
-#include <QGraphicsView>
 #include <QSplitter>
 #include <QGroupBox>
 #include <QRadioButton>
 #include <QButtonGroup>
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     setWindowTitle("DFA Minimizer (Hopcroft)");
@@ -18,8 +22,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     
     // Central View
     m_scene = new GraphScene(this);
-    m_view = new QGraphicsView(m_scene);
-    m_view->setRenderHint(QPainter::Antialiasing);
+    m_view = new GraphView(m_scene);
     m_view->setDragMode(QGraphicsView::RubberBandDrag);
     setCentralWidget(m_view);
     
@@ -63,6 +66,15 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     buildLayout->addWidget(btnImport);
     buildLayout->addWidget(btnExport);
     
+    // Layout
+    buildLayout->addWidget(new QLabel("Layout:"));
+    m_layoutCombo = new QComboBox();
+    m_layoutCombo->addItem("Layered (BFS depth)", int(LayoutAlgorithm::Layered));
+    m_layoutCombo->addItem("Force-directed", int(LayoutAlgorithm::ForceDirected));
+    m_layoutButton = new QPushButton("Auto Layout");
+    buildLayout->addWidget(m_layoutCombo);
+    buildLayout->addWidget(m_layoutButton);
+    
     buildLayout->addStretch();
     buildDock->setWidget(buildWidget);
     addDockWidget(Qt::LeftDockWidgetArea, buildDock);
@@ -73,8 +85,26 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     QWidget* algoWidget = new QWidget();
     QVBoxLayout* algoLayout = new QVBoxLayout(algoWidget);
     
-    QPushButton* btnRun = new QPushButton("Run Minimization");
-    algoLayout->addWidget(btnRun);
+    algoLayout->addWidget(new QLabel("Algorithm:"));
+    m_algorithmCombo = new QComboBox();
+    m_algorithmCombo->addItem("Hopcroft (step timeline)", int(MinimizerAlgorithm::Hopcroft));
+    m_algorithmCombo->addItem("Valmari-Lehtinen (partial DFA, no sink)", int(MinimizerAlgorithm::Valmari));
+    m_algorithmCombo->addItem("Parallel Moore (all cores)", int(MinimizerAlgorithm::ParallelMoore));
+    algoLayout->addWidget(m_algorithmCombo);
+    m_incrementalCheck = new QCheckBox("Incremental re-run (Hopcroft, no timeline)");
+    m_incrementalCheck->setToolTip("Re-minimizes only what the edits since the last incremental run can affect");
+    algoLayout->addWidget(m_incrementalCheck);
+
+    QHBoxLayout* runLayout = new QHBoxLayout();
+    m_runButton = new QPushButton("Run Minimization");
+    m_cancelButton = new QPushButton("Cancel");
+    m_cancelButton->setEnabled(false);
+    runLayout->addWidget(m_runButton);
+    runLayout->addWidget(m_cancelButton);
+    algoLayout->addLayout(runLayout);
+    m_progress = new QProgressBar();
+    m_progress->setVisible(false);
+    algoLayout->addWidget(m_progress);
     
     // View Toggle
     QGroupBox* viewGroup = new QGroupBox("View");
@@ -116,7 +146,9 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     connect(btnVal, &QPushButton::clicked, this, &MainWindow::onValidate);
     connect(btnImport, &QPushButton::clicked, this, &MainWindow::onImportJson);
     connect(btnExport, &QPushButton::clicked, this, &MainWindow::onExportJson);
-    connect(btnRun, &QPushButton::clicked, this, &MainWindow::onRunHopcroft);
+    connect(m_layoutButton, &QPushButton::clicked, this, &MainWindow::onAutoLayout);
+    connect(m_runButton, &QPushButton::clicked, this, &MainWindow::onRunHopcroft);
+    connect(m_cancelButton, &QPushButton::clicked, this, &MainWindow::onCancelRun);
     connect(m_stepsList, &QListWidget::currentRowChanged, this, &MainWindow::onStepSelected);
 
     // Initial alphabet
@@ -154,38 +186,73 @@ void MainWindow::onUpdateAlphabet() {
 }
 
 void MainWindow::onImportJson() {
-    QString path = QFileDialog::getOpenFileName(this, "Import DFA", "", "JSON (*.json)");
+    QString path = QFileDialog::getOpenFileName(this, "Import DFA", "", "Automata (*.json *.dfab *.re *.regex);;JSON (*.json);;Binary DFA (*.dfab);;Regular expressions, one per line (*.re *.regex)");
     if (path.isEmpty()) return;
     
-    QFile f(path);
-    if (f.open(QIODevice::ReadOnly)) {
-        DFA dfa;
-        QString err;
-        if (DFAJson::fromJson(f.readAll(), dfa, err)) {
-            m_scene->loadFromDFA(dfa);
-            
-            // Update UI alphabet
-            QStringList alphaList;
-            for(auto s : dfa.alphabet) alphaList << QString::fromStdString(s);
-            m_alphabetEdit->setText(alphaList.join(","));
-            
-            statusBar()->showMessage("Loaded DFA.");
-        } else {
-            QMessageBox::warning(this, "Error", "Failed to load: " + err);
+    DFA dfa;
+    QString err;
+    QString loaded = "Loaded DFA.";
+    bool ok = false;
+    if (path.endsWith(".dfab", Qt::CaseInsensitive)) {
+        // Memory-mapped binary load
+        CompactDFA compact;
+        ok = DFABinary::load(path, compact, err);
+        if (ok) dfa = compact.toDFA();
+    } else if (path.endsWith(".re", Qt::CaseInsensitive) || path.endsWith(".regex", Qt::CaseInsensitive)) {
+        // Compiled to a DFA; Run Minimization then shows how it shrinks
+        CompactDFA compact;
+        ok = Regex::load(path, compact, err);
+        if (ok) dfa = compact.toDFA();
+    } else {
+        // Read as an NFA, which keeps every start state; repeated (state,
+        // symbol) pairs, ε-transitions or several starts are determinized
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly)) return;
+        NFA nfa;
+        ok = DFAJsonStream::read(f, nfa, err);
+        if (ok && SubsetConstruction::needed(nfa)) {
+            dfa = SubsetConstruction::determinize(nfa).toDFA();
+            loaded = QString("Determinized NFA: %1 -> %2 states.").arg(nfa.numStates()).arg(dfa.states.size());
+        } else if (ok) {
+            dfa = nfa.toDFA();
+        }
+    }
+    
+    if (ok) {
+
+        // Update UI alphabet
+        QStringList alphaList;
+        for(auto s : dfa.alphabet) alphaList << QString::fromStdString(s);
+        m_alphabetEdit->setText(alphaList.join(","));
+        
+        if (Layout::needsLayout(dfa)) {
+            // No usable coordinates in the file; show it once it is placed
+            startLayout(dfa, loaded);
+            return;
         }
+        m_scene->loadFromDFA(dfa);
+        m_view->zoomToFit();
+        statusBar()->showMessage(loaded);
+    } else {
+        QMessageBox::warning(this, "Error", "Failed to load: " + err);
     }
 }
 
 void MainWindow::onExportJson() {
     DFA dfa = m_scene->exportToDFA();
-    QByteArray data = DFAJson::toJson(dfa);
     
-    QString path = QFileDialog::getSaveFileName(this, "Export DFA", "", "JSON (*.json)");
+    QString path = QFileDialog::getSaveFileName(this, "Export DFA", "", "JSON (*.json);;Binary DFA (*.dfab)");
     if (path.isEmpty()) return;
     
+    if (path.endsWith(".dfab", Qt::CaseInsensitive)) {
+        QString err;
+        if (DFABinary::save(path, CompactDFA::fromDFA(dfa), err)) statusBar()->showMessage("Saved DFA.");
+        else QMessageBox::warning(this, "Error", "Failed to save: " + err);
+        return;
+    }
+    
     QFile f(path);
-    if (f.open(QIODevice::WriteOnly)) {
-        f.write(data);
+    if (f.open(QIODevice::WriteOnly) && DFAJsonStream::write(f, dfa)) {
         statusBar()->showMessage("Saved DFA.");
     }
 }
@@ -193,13 +260,11 @@ void MainWindow::onExportJson() {
 void MainWindow::onValidate() {
     DFA dfa = m_scene->exportToDFA();
     auto missing = dfa.getMissingTransitions();
-    bool deterministic = dfa.isDeterministic(); // Basic check
-    // Advanced deterministic check: Ensure no state has >1 transition for same symbol
-    // Our map model structure in DFA.h handles unique keys, but the Scene might produce
-    // duplicate arrows visually. The exportToDFA combines them or overwrites.
-    // Let's rely on Scene export correctness.
+    // Two arrows with the same symbol out of one state end up in conflicts
+    bool deterministic = dfa.isDeterministic();
     
     QString status = "DFA is ";
+    if (!deterministic) status += "Nondeterministic (" + QString::number(dfa.conflicts.size()) + " conflicting transitions). ";
     if (missing.empty()) status += "Complete. ";
     else status += "Partial (Missing " + QString::number(missing.size()) + " transitions). ";
     
@@ -213,27 +278,107 @@ void MainWindow::onCompleteSink() {
     statusBar()->showMessage("Completed with Sink State.");
 }
 
+void MainWindow::onAutoLayout() {
+    startLayout(m_scene->exportToDFA());
+}
+
+void MainWindow::startLayout(const DFA& dfa, const QString& loaded) {
+    if (m_layoutTask) m_layoutTask->cancel();
+    
+    LayoutOptions options;
+    options.algorithm = LayoutAlgorithm(m_layoutCombo->currentData().toInt());
+    LayoutTask* task = new LayoutTask(dfa, options, this);
+    m_layoutTask = task;
+    connect(task, &LayoutTask::finished, this, [this, task, loaded](bool cancelled) {
+        // A superseded run only cleans up after itself
+        if (!cancelled && task == m_layoutTask) {
+            m_scene->loadFromDFA(task->result());
+            m_view->zoomToFit();
+            QString laidOut = QString("Laid out %1 states.").arg(task->result().states.size());
+            statusBar()->showMessage(loaded.isEmpty() ? laidOut : loaded + " " + laidOut);
+        }
+        if (task == m_layoutTask) {
+            m_layoutTask = nullptr;
+            m_layoutButton->setEnabled(true);
+        }
+        task->deleteLater();
+    });
+    m_layoutButton->setEnabled(false);
+    task->start();
+    statusBar()->showMessage("Laying out " + QString::number(dfa.states.size()) + " states...");
+}
+
 void MainWindow::onRunHopcroft() {
+    if (m_task) return;
     m_originalDFA = m_scene->exportToDFA();
-    auto result = Hopcroft::minimize(m_originalDFA);
-    m_minimizedDFA = result.first;
-    m_history = result.second;
     
+    MinimizerOptions options;
+    options.algorithm = MinimizerAlgorithm(m_algorithmCombo->currentData().toInt());
+    
+    // Only the Hopcroft run records a timeline; its steps arrive while it runs
+    m_timeline = HopcroftTimeline();
     m_stepsList->clear();
-    for (size_t i=0; i<m_history.size(); ++i) {
-        m_stepsList->addItem(QString("Step %1: Split by '%2'")
-                             .arg(i+1)
-                             .arg(QString::fromStdString(m_history[i].symbol)));
+    m_detailsText->clear();
+    m_progress->setRange(0, std::max<int>(1, int(m_originalDFA.states.size())));
+    m_progress->setValue(0);
+    m_progress->setFormat("Starting...");
+    m_progress->setVisible(true);
+    m_runButton->setEnabled(false);
+    m_cancelButton->setEnabled(true);
+    
+    m_task = new MinimizeTask(m_originalDFA, options, this);
+    if (options.algorithm == MinimizerAlgorithm::Hopcroft && m_incrementalCheck->isChecked()) {
+        // The run always completes, so its input becomes the new baseline
+        m_task->setIncremental(&m_incremental, m_scene->journal());
+        m_scene->clearJournal();
+    } else {
+        m_incremental.reset();
     }
+    connect(m_task, &MinimizeTask::progress, this, [this](int blocks, int worklist, int steps) {
+        m_progress->setValue(blocks);
+        m_progress->setFormat(QString("%1 blocks, %2 queued, %3 steps").arg(blocks).arg(worklist).arg(steps));
+    });
+    connect(m_task, &MinimizeTask::stepsAdded, m_stepsList, &QListWidget::addItems);
+    connect(m_task, &MinimizeTask::finished, this, &MainWindow::onRunFinished);
+    m_task->start();
+    statusBar()->showMessage("Minimizing...");
+}
+
+void MainWindow::onCancelRun() {
+    if (!m_task) return;
+    m_task->cancel();
+    m_cancelButton->setEnabled(false);
+    statusBar()->showMessage("Cancelling...");
+}
+
+void MainWindow::onRunFinished(bool cancelled) {
+    m_runButton->setEnabled(true);
+    m_cancelButton->setEnabled(false);
+    m_progress->setVisible(false);
     
-    QMessageBox::information(this, "Hopcroft", "Minimization Complete! " + QString::number(m_minimizedDFA.states.size()) + " states.");
+    if (cancelled) {
+        // Partial steps refer to a timeline that was never completed
+        m_stepsList->clear();
+        statusBar()->showMessage("Minimization cancelled.");
+    } else {
+        m_minimizedDFA = m_task->result();
+        m_timeline = m_task->takeTimeline();
+        statusBar()->clearMessage();
+        const IncrementalMinimizer::Stats& run = m_incremental.lastRun();
+        if (run.incremental) {
+            statusBar()->showMessage(QString("Incremental: %1 edited, %2 affected, %3 of %4 states minimized.")
+                                         .arg(run.dirty).arg(run.cone).arg(run.reduced).arg(m_originalDFA.states.size()));
+        }
+        QMessageBox::information(this, m_algorithmCombo->currentText(), "Minimization Complete! " + QString::number(m_minimizedDFA.states.size()) + " states.");
+    }
+    m_task->deleteLater();
+    m_task = nullptr;
 }
 
 void MainWindow::onStepSelected(int index) {
-    if (index < 0 || index >= (int)m_history.size()) return;
+    if (index < 0 || index >= (int)m_timeline.numSteps()) return;
     
-    const auto& step = m_history[index];
-    m_detailsText->setText(QString::fromStdString(step.explanation));
+    m_detailsText->setText(QString::fromStdString(m_timeline.explanation(index)));
     
     // Highlight states in scene
     m_scene->clearHighlights();
@@ -245,14 +390,19 @@ void MainWindow::onStepSelected(int index) {
     // To visualize this on the *Original* graph (which the algo ran on), ensure we are in Original View
     // (Assuming user hasn't switched to Minimized view yet, or we force it)
     
-    m_scene->highlightStates(std::vector<std::string>(step.A.begin(), step.A.end()), Qt::cyan);
-    m_scene->highlightStates(std::vector<std::string>(step.X.begin(), step.X.end()), Qt::yellow);
+    // The timeline works on state indices of the run's automaton
+    const CompactDFA& ran = m_timeline.dfa();
+    auto ids = [&](const std::vector<uint32_t>& states) {
+        std::vector<std::string> out;
+        out.reserve(states.size());
+        for (uint32_t q : states) out.push_back(ran.stateId(q));
+        return out;
+    };
+    m_scene->highlightStates(ids(m_timeline.splitter(index)), Qt::cyan);
+    m_scene->highlightStates(ids(m_timeline.preimage(index)), Qt::yellow);
     
     // Only highlight states involved in a split
-    for (const auto& split : step.splits) {
-         std::vector<std::string> Yvec(split.Y.begin(), split.Y.end());
-         m_scene->highlightStates(Yvec, Qt::red);
-    }
+    m_scene->highlightStates(ids(m_timeline.splitBlocks(index)), Qt::red);
 }
 
 void MainWindow::onViewOriginal(bool checked) {
@@ -4,8 +4,16 @@
 #include <QTextEdit>
 #include <QLineEdit>
 #include <QLabel>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QPointer>
+#include <QProgressBar>
+#include <QPushButton>
 #include "GraphScene.h"
+#include "GraphView.h"
 #include "algorithms/Hopcroft.h"
+#include "MinimizeTask.h"
+#include "LayoutTask.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -23,23 +31,39 @@ private slots:
     void onExportJson();
     void onValidate();
     void onRunHopcroft();
+    void onCancelRun();
+    void onRunFinished(bool cancelled);
     void onStepSelected(int index);
     void onViewOriginal(bool checked);
     void onViewMinimized(bool checked);
     void onCompleteSink();
+    void onAutoLayout();
 
 private:
+    // loaded, if given, leads the status message once the layout is done
+    void startLayout(const DFA& dfa, const QString& loaded = QString());
+
     GraphScene* m_scene;
-    QGraphicsView* m_view;
+    GraphView* m_view;
     
     // UI Elements
     QLineEdit* m_alphabetEdit;
     QLabel* m_validationLabel;
+    QComboBox* m_layoutCombo;
+    QPushButton* m_layoutButton;
+    QPointer<LayoutTask> m_layoutTask;
     
     // Hopcroft
+    QComboBox* m_algorithmCombo;
+    QCheckBox* m_incrementalCheck;
+    IncrementalMinimizer m_incremental; // baseline of the last incremental run
+    QPushButton* m_runButton;
+    QPushButton* m_cancelButton;
+    QProgressBar* m_progress;
+    QPointer<MinimizeTask> m_task;
     QListWidget* m_stepsList;
     QTextEdit* m_detailsText;
-    std::vector<HopcroftStep> m_history;
+    HopcroftTimeline m_timeline;
     DFA m_originalDFA;
     DFA m_minimizedDFA;
 };
\ No newline at end of file
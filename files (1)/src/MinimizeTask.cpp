@@ -0,0 +1,94 @@
+#include "MinimizeTask.h"
+#include "layout/Layout.h"
+#include <QElapsedTimer>
+#include <algorithm>
+
+// Records the full trace and forwards progress from the worker thread
+class MinimizeTask::Reporter : public HopcroftRecorder {
+public:
+    Reporter(MinimizeTask& task) : HopcroftRecorder(TraceLevel::Full), m_task(task) {}
+
+    void started(const std::vector<uint32_t>& blockOf) override {
+        HopcroftRecorder::started(blockOf);
+        for (uint32_t b : blockOf) m_initialBlocks = std::max(m_initialBlocks, b + 1);
+        m_clock.start();
+    }
+    void splitterChosen(uint32_t block, size_t worklist) override {
+        HopcroftRecorder::splitterChosen(block, worklist);
+        m_worklist = worklist;
+    }
+    void symbolDone(uint32_t symbol) override {
+        size_t before = trace().steps.size();
+        HopcroftRecorder::symbolDone(symbol);
+        if (trace().steps.size() == before) return;
+        m_pending << QString("Step %1: Split by '%2'").arg(before + 1).arg(QString::fromStdString(m_symbols[symbol]));
+        if (m_clock.elapsed() >= 100) flush();
+    }
+    void finished(uint32_t numBlocks) override {
+        HopcroftRecorder::finished(numBlocks);
+        flush();
+    }
+    bool cancelled() override { return m_task.m_cancel; }
+
+    void setSymbols(const std::vector<std::string>& symbols) { m_symbols = symbols; }
+
+private:
+    void flush() {
+        const HopcroftStats& s = trace().stats;
+        emit m_task.progress(int(m_initialBlocks + s.splits), int(m_worklist), int(s.steps));
+        if (!m_pending.isEmpty()) emit m_task.stepsAdded(m_pending);
+        m_pending.clear();
+        m_clock.restart();
+    }
+
+    MinimizeTask& m_task;
+    std::vector<std::string> m_symbols;
+    QStringList m_pending;
+    QElapsedTimer m_clock;
+    uint32_t m_initialBlocks = 0;
+    size_t m_worklist = 0;
+};
+
+MinimizeTask::MinimizeTask(const DFA& dfa, const MinimizerOptions& options, QObject* parent)
+    : QObject(parent), m_input(dfa), m_options(options) {}
+
+MinimizeTask::~MinimizeTask() {
+    if (m_thread) {
+        m_cancel = true;
+        m_thread->wait();
+    }
+}
+
+void MinimizeTask::setIncremental(IncrementalMinimizer* minimizer, const std::vector<DFAEdit>& journal) {
+    m_incremental = minimizer;
+    m_journal = journal;
+}
+
+void MinimizeTask::start() {
+    m_thread = QThread::create([this] { run(); });
+    m_thread->setParent(this);
+    // Emitted by the worker; queued to the thread this task lives in
+    connect(m_thread, &QThread::finished, this, [this] { emit finished(m_cancel); });
+    m_thread->start();
+}
+
+void MinimizeTask::run() {
+    if (m_incremental) {
+        m_result = m_incremental->update(CompactDFA::fromDFA(m_input), m_journal).toDFA();
+    } else if (m_options.algorithm == MinimizerAlgorithm::Hopcroft) {
+        Reporter reporter(*this);
+        // Symbols as the run numbers them: the input alphabet in order
+        reporter.setSymbols(CompactDFA::fromDFA(m_input).symbols());
+        auto result = Hopcroft::minimize(m_input, reporter);
+        m_result = std::move(result.first);
+        m_timeline = std::move(result.second);
+    } else {
+        m_result = Minimizer::minimize(m_input, m_options);
+    }
+    // Classes sit where their first member was; only stacked inputs need a layout
+    if (!m_cancel && Layout::needsLayout(m_result)) {
+        LayoutOptions layout;
+        layout.cancel = &m_cancel;
+        Layout::apply(m_result, layout);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+#include <QObject>
+#include <QStringList>
+#include <QThread>
+#include <atomic>
+#include "algorithms/Hopcroft.h"
+#include "algorithms/IncrementalMinimizer.h"
+#include "algorithms/Minimizer.h"
+
+// One minimization run on its own thread. Progress and timeline steps are
+// delivered as queued signals, a few times per second at most, so a large
+// run keeps the window responsive. Hopcroft runs stop at the next splitter
+// when cancelled; the other engines cannot be interrupted, so their result
+// is discarded instead. An incremental run (see setIncremental) records no
+// timeline and always completes, so its minimizer's baseline moves to this
+// run's input even when the result is discarded. A result whose states
+// would overlap is laid out on the same thread.
+class MinimizeTask : public QObject {
+    Q_OBJECT
+public:
+    MinimizeTask(const DFA& dfa, const MinimizerOptions& options, QObject* parent = nullptr);
+    ~MinimizeTask() override; // cancels and waits for the thread
+
+    // Re-minimize through minimizer, which must outlive the run, instead of
+    // a full run; journal lists the edits since its baseline
+    void setIncremental(IncrementalMinimizer* minimizer, const std::vector<DFAEdit>& journal);
+
+    void start();
+    void cancel() { m_cancel = true; }
+    bool isCancelled() const { return m_cancel; }
+
+    // Valid once finished() has been emitted without cancellation
+    const DFA& result() const { return m_result; }
+    HopcroftTimeline takeTimeline() { return std::move(m_timeline); }
+
+signals:
+    void progress(int blocks, int worklist, int steps);
+    void stepsAdded(const QStringList& labels); // timeline entries in run order
+    void finished(bool cancelled);
+
+private:
+    class Reporter;
+    void run();
+
+    QThread* m_thread = nullptr;
+    std::atomic<bool> m_cancel{false};
+    DFA m_input;
+    MinimizerOptions m_options;
+    IncrementalMinimizer* m_incremental = nullptr;
+    std::vector<DFAEdit> m_journal;
+    DFA m_result;
+    HopcroftTimeline m_timeline;
+};
\ No newline at end of file
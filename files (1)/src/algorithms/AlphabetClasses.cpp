@@ -0,0 +1,79 @@
+#include "AlphabetClasses.h"
+#include <unordered_map>
+
+namespace {
+
+constexpr uint32_t NONE = CompactDFA::NONE;
+
+bool sameColumn(const CompactDFA& dfa, uint32_t a, uint32_t b) {
+    for (uint32_t q = 0; q < dfa.numStates(); ++q) {
+        if (dfa.next(q, a) != dfa.next(q, b)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+AlphabetClasses AlphabetClasses::of(const CompactDFA& dfa) {
+    const uint32_t k = dfa.numSymbols();
+    std::vector<uint64_t> hash(k, 0x9E3779B97F4A7C15ull);
+    for (uint32_t q = 0; q < dfa.numStates(); ++q) {
+        const uint32_t* r = dfa.row(q);
+        for (uint32_t a = 0; a < k; ++a) hash[a] = (hash[a] ^ r[a]) * 0xFF51AFD7ED558CCDull;
+    }
+
+    // Classes with the same column hash are chained through nextWithHash
+    AlphabetClasses classes;
+    classes.m_classOf.resize(k);
+    std::unordered_map<uint64_t, uint32_t> firstWithHash;
+    std::vector<uint32_t> nextWithHash;
+    for (uint32_t a = 0; a < k; ++a) {
+        auto it = firstWithHash.find(hash[a]);
+        uint32_t c = it != firstWithHash.end() ? it->second : NONE, last = NONE;
+        while (c != NONE && !sameColumn(dfa, classes.m_representative[c], a)) {
+            last = c;
+            c = nextWithHash[c];
+        }
+        if (c == NONE) {
+            c = classes.numClasses();
+            classes.m_representative.push_back(a);
+            nextWithHash.push_back(NONE);
+            if (last != NONE) nextWithHash[last] = c;
+            else firstWithHash.emplace(hash[a], c);
+        }
+        classes.m_classOf[a] = c;
+    }
+    return classes;
+}
+
+CompactDFA AlphabetClasses::compress(const CompactDFA& dfa) const {
+    CompactDFA narrow;
+    narrow.reserve(dfa.numStates(), numClasses());
+    for (uint32_t c = 0; c < numClasses(); ++c) narrow.addSymbol(dfa.symbol(m_representative[c]));
+    for (uint32_t q = 0; q < dfa.numStates(); ++q) {
+        narrow.addState(dfa.stateId(q), dfa.isStart(q), dfa.isAccept(q), dfa.x(q), dfa.y(q));
+        const uint32_t* r = dfa.row(q);
+        for (uint32_t c = 0; c < numClasses(); ++c) narrow.setTransition(q, c, r[m_representative[c]]);
+    }
+    return narrow;
+}
+
+CompactDFA AlphabetClasses::expand(const CompactDFA& narrow, const CompactDFA& original) const {
+    // Column of every original symbol in narrow, through its class's name
+    std::vector<uint32_t> column(original.numSymbols());
+    for (uint32_t a = 0; a < original.numSymbols(); ++a) {
+        column[a] = narrow.symbolIndex(original.symbol(m_representative[m_classOf[a]]));
+    }
+
+    CompactDFA wide;
+    wide.reserve(narrow.numStates(), original.numSymbols());
+    for (const auto& sym : original.symbols()) wide.addSymbol(sym);
+    for (uint32_t q = 0; q < narrow.numStates(); ++q) {
+        wide.addState(narrow.stateId(q), narrow.isStart(q), narrow.isAccept(q), narrow.x(q), narrow.y(q));
+        const uint32_t* r = narrow.row(q);
+        for (uint32_t a = 0; a < original.numSymbols(); ++a) {
+            if (column[a] != NONE) wide.setTransition(q, a, r[column[a]]);
+        }
+    }
+    return wide;
+}
\ No newline at end of file
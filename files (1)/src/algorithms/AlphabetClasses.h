@@ -0,0 +1,32 @@
+#pragma once
+#include "../model/CompactDFA.h"
+#include <vector>
+
+// Partition of an automaton's alphabet into symbols that behave the same in
+// every state: a and b share a class when their transition columns are equal.
+// On byte-level automata most of the 256 symbols usually collapse into a
+// handful of classes, and running over one symbol per class shrinks both the
+// refinement work of the minimizers and the width of the matcher's table.
+class AlphabetClasses {
+public:
+    // Columns are hashed in one row-major pass over the table; equal hashes
+    // are confirmed column by column. Classes are numbered in order of their
+    // first symbol. O(n·|Σ|).
+    static AlphabetClasses of(const CompactDFA& dfa);
+
+    uint32_t numClasses() const { return uint32_t(m_representative.size()); }
+    uint32_t classOf(uint32_t symbol) const { return m_classOf[symbol]; }
+    // First symbol of class c
+    uint32_t representative(uint32_t c) const { return m_representative[c]; }
+
+    // dfa over one symbol per class, named after the class's first symbol;
+    // states, flags and positions are unchanged
+    CompactDFA compress(const CompactDFA& dfa) const;
+    // An automaton over compress(original)'s alphabet, such as its minimized
+    // form, with every symbol of original restored
+    CompactDFA expand(const CompactDFA& narrow, const CompactDFA& original) const;
+
+private:
+    std::vector<uint32_t> m_classOf;
+    std::vector<uint32_t> m_representative;
+};
\ No newline at end of file
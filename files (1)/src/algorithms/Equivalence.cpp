@@ -0,0 +1,128 @@
+#include "Equivalence.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint32_t NONE = CompactDFA::NONE;
+
+// Both alphabets merged: a's symbols in order, then b's other ones. Column
+// x of the merged alphabet is column inA[x] of a and inB[x] of b, NONE where
+// the symbol is missing.
+struct Alphabet {
+    std::vector<std::string> names;
+    std::vector<uint32_t> inA;
+    std::vector<uint32_t> inB;
+
+    Alphabet(const CompactDFA& a, const CompactDFA& b) {
+        for (uint32_t x = 0; x < a.numSymbols(); ++x) {
+            names.push_back(a.symbol(x));
+            inA.push_back(x);
+            inB.push_back(b.symbolIndex(a.symbol(x)));
+        }
+        for (uint32_t x = 0; x < b.numSymbols(); ++x) {
+            if (a.symbolIndex(b.symbol(x)) != NONE) continue;
+            names.push_back(b.symbol(x));
+            inA.push_back(NONE);
+            inB.push_back(x);
+        }
+    }
+    uint32_t size() const { return uint32_t(names.size()); }
+};
+
+// NONE is the dead state: it rejects and never leaves
+uint32_t step(const CompactDFA& dfa, uint32_t q, uint32_t column) {
+    return q == NONE || column == NONE ? NONE : dfa.next(q, column);
+}
+
+bool accepting(const CompactDFA& dfa, uint32_t q) { return q != NONE && dfa.isAccept(q); }
+
+// Breadth-first over the reachable pairs of the product until bad(accepting
+// in a, accepting in b) holds; the path to the first such pair is a shortest
+// word leading there. Pairs are numbered through a hash as they are reached.
+template <class Bad>
+bool findPair(const CompactDFA& a, const CompactDFA& b, const Alphabet& sigma, Bad bad, std::vector<std::string>* word) {
+    struct Node {
+        uint32_t p, q;
+        uint32_t parent, symbol;
+    };
+    std::vector<Node> nodes;
+    std::unordered_map<uint64_t, uint32_t> seen;
+    auto visit = [&](uint32_t p, uint32_t q, uint32_t parent, uint32_t symbol) {
+        if (seen.emplace((uint64_t(p) << 32) | q, uint32_t(nodes.size())).second) nodes.push_back({p, q, parent, symbol});
+    };
+
+    visit(a.startState(), b.startState(), NONE, NONE);
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        const Node n = nodes[i];
+        if (bad(accepting(a, n.p), accepting(b, n.q))) {
+            if (word) {
+                word->clear();
+                for (uint32_t j = i; nodes[j].parent != NONE; j = nodes[j].parent) word->push_back(sigma.names[nodes[j].symbol]);
+                std::reverse(word->begin(), word->end());
+            }
+            return true;
+        }
+        if (n.p == NONE && n.q == NONE) continue; // nothing changes past here
+        for (uint32_t x = 0; x < sigma.size(); ++x) visit(step(a, n.p, sigma.inA[x]), step(b, n.q, sigma.inB[x]), i, x);
+    }
+    return false;
+}
+
+} // namespace
+
+bool Equivalence::equivalent(const CompactDFA& a, const CompactDFA& b, std::vector<std::string>* counterexample) {
+    Alphabet sigma(a, b);
+
+    // Union-find ids: a's states, then b's, then the dead state both share
+    const uint32_t nA = a.numStates();
+    const uint32_t dead = nA + b.numStates();
+    std::vector<uint32_t> parent(size_t(dead) + 1), size(size_t(dead) + 1, 1);
+    for (uint32_t i = 0; i <= dead; ++i) parent[i] = i;
+    auto find = [&](uint32_t x) {
+        while (parent[x] != x) x = parent[x] = parent[parent[x]];
+        return x;
+    };
+
+    // Every successful union queues its pair; a pair is only checked once
+    std::vector<std::pair<uint32_t, uint32_t>> todo;
+    auto merge = [&](uint32_t p, uint32_t q) {
+        uint32_t x = find(p == NONE ? dead : p);
+        uint32_t y = find(q == NONE ? dead : nA + q);
+        if (x == y) return;
+        if (size[x] < size[y]) std::swap(x, y);
+        parent[y] = x;
+        size[x] += size[y];
+        todo.push_back({p, q});
+    };
+
+    merge(a.startState(), b.startState());
+    bool same = true;
+    while (!todo.empty()) {
+        auto [p, q] = todo.back();
+        todo.pop_back();
+        if (accepting(a, p) != accepting(b, q)) {
+            same = false;
+            break;
+        }
+        for (uint32_t x = 0; x < sigma.size(); ++x) merge(step(a, p, sigma.inA[x]), step(b, q, sigma.inB[x]));
+    }
+
+    // The merge order says nothing about word length; a shortest witness
+    // needs the breadth-first pair search, paid only when the languages differ
+    if (!same && counterexample) findPair(a, b, sigma, [](bool x, bool y) { return x != y; }, counterexample);
+    return same;
+}
+
+bool Equivalence::included(const CompactDFA& a, const CompactDFA& b, std::vector<std::string>* counterexample) {
+    Alphabet sigma(a, b);
+    return !findPair(a, b, sigma, [](bool x, bool y) { return x && !y; }, counterexample);
+}
+
+bool Equivalence::equivalent(const DFA& a, const DFA& b, std::vector<std::string>* counterexample) {
+    return equivalent(CompactDFA::fromDFA(a), CompactDFA::fromDFA(b), counterexample);
+}
+
+bool Equivalence::included(const DFA& a, const DFA& b, std::vector<std::string>* counterexample) {
+    return included(CompactDFA::fromDFA(a), CompactDFA::fromDFA(b), counterexample);
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+#include "../model/DFA.h"
+#include "../model/CompactDFA.h"
+#include <string>
+#include <vector>
+
+// Language equivalence and inclusion without minimizing either side. Missing
+// transitions reject, and a symbol outside one automaton's alphabet acts as a
+// missing transition there, so a partial automaton and its sink-completed
+// form compare equal.
+class Equivalence {
+public:
+    // Hopcroft–Karp: union-find over the disjoint union of a and b plus one
+    // shared dead state. Merging the start states and then the targets of
+    // every merged pair either closes without conflict or reaches an
+    // accepting state merged with a rejecting one; O(m·α(n)) overall. When the
+    // languages differ, counterexample (if given) receives a shortest word
+    // accepted by exactly one of them.
+    static bool equivalent(const CompactDFA& a, const CompactDFA& b, std::vector<std::string>* counterexample = nullptr);
+    static bool equivalent(const DFA& a, const DFA& b, std::vector<std::string>* counterexample = nullptr);
+
+    // L(a) ⊆ L(b). This is "L(a) ∪ L(b) equals L(b)", but in that check each
+    // union state only ever meets its own b component, so the union-find
+    // degenerates to a visited set: the search walks the reachable pairs of
+    // the product, the same pair search that finds equivalence
+    // counterexamples. counterexample receives a shortest word in L(a) \ L(b).
+    static bool included(const CompactDFA& a, const CompactDFA& b, std::vector<std::string>* counterexample = nullptr);
+    static bool included(const DFA& a, const DFA& b, std::vector<std::string>* counterexample = nullptr);
+};
\ No newline at end of file
@@ -1,175 +1,183 @@
 #include "Hopcroft.h"
-#include <iostream>
-#include <algorithm>
-#include <sstream>
+#include "Partition.h"
+#include "Quotient.h"
 
-// Helper to check set equality
-bool setsEqual(const std::set<std::string>& a, const std::set<std::string>& b) {
-    return a == b;
-}
+namespace {
 
-std::pair<DFA, std::vector<HopcroftStep>> Hopcroft::minimize(const DFA& inputDFA) {
-    DFA dfa = inputDFA;
-    
-    // Preprocessing: Remove unreachable states
-    // Note: Completeness should ideally be handled before this call by the user or auto-sink.
-    dfa.removeUnreachable(); 
-    
-    std::set<std::string> F, Q_minus_F;
-    std::set<std::string> allStates;
-    
-    for (const auto& s : dfa.states) {
-        allStates.insert(s.id);
-        if (s.isAccept) F.insert(s.id);
-        else Q_minus_F.insert(s.id);
-    }
-    
-    std::vector<std::set<std::string>> P;
-    if (!F.empty()) P.push_back(F);
-    if (!Q_minus_F.empty()) P.push_back(Q_minus_F);
-    
-    // W = {F} if |F| <= |Q\F| else {Q\F}. 
-    // Actually standard Hopcroft initializes W = {F, Q\F} is also fine, 
-    // or typically just {F} is enough to start if F is smaller.
-    // Let's stick to standard Algorithm: W = P
-    std::vector<std::set<std::string>> W = P;
-    
-    std::vector<HopcroftStep> history;
-    
-    while (!W.empty()) {
-        std::set<std::string> A = W.back();
-        W.pop_back();
-        
-        for (const auto& c : dfa.alphabet) {
-            // X = { q | delta(q,c) in A }
-            std::set<std::string> X;
-            for (const auto& s : dfa.states) {
-                if (dfa.transitions.count({s.id, c})) {
-                    std::string dest = dfa.transitions.at({s.id, c});
-                    if (A.count(dest)) {
-                        X.insert(s.id);
-                    }
-                }
-            }
-            
-            if (X.empty()) continue;
-
-            HopcroftStep step;
-            step.partitionsBefore = P;
-            step.A = A;
-            step.symbol = c;
-            step.X = X;
-            
-            std::vector<std::set<std::string>> nextP;
-            bool anySplit = false;
-            
-            for (const auto& Y : P) {
-                std::set<std::string> intersection;
-                std::set<std::string> difference;
-                
-                std::set_intersection(Y.begin(), Y.end(), X.begin(), X.end(),
-                                      std::inserter(intersection, intersection.begin()));
-                std::set_difference(Y.begin(), Y.end(), X.begin(), X.end(),
-                                    std::inserter(difference, difference.begin()));
-                
-                if (!intersection.empty() && !difference.empty()) {
-                    // Split Y into intersection and difference
-                    nextP.push_back(intersection);
-                    nextP.push_back(difference);
-                    
-                    HopcroftSplit splitInfo;
-                    splitInfo.Y = Y;
-                    splitInfo.Y_intersect_X = intersection;
-                    splitInfo.Y_minus_X = difference;
-                    step.splits.push_back(splitInfo);
-                    
-                    // Update W
-                    // If Y is in W, replace Y with intersection and difference
-                    auto itW = std::find(W.begin(), W.end(), Y);
-                    if (itW != W.end()) {
-                        W.erase(itW);
-                        W.push_back(intersection);
-                        W.push_back(difference);
-                    } else {
-                        // If not in W, add the smaller one
-                        if (intersection.size() <= difference.size()) {
-                            W.push_back(intersection);
-                        } else {
-                            W.push_back(difference);
-                        }
-                    }
-                    anySplit = true;
-                } else {
-                    nextP.push_back(Y);
-                }
-            }
-            P = nextP;
-            step.partitionsAfter = P;
-            
-            if (anySplit) {
-                 std::stringstream ss;
-                 ss << "Refining partition with respect to set A and symbol '" << c << "'. "
-                    << step.splits.size() << " blocks were split.";
-                 step.explanation = ss.str();
-                 history.push_back(step);
-            }
+// Stand-in for a HopcroftObserver whose calls compile to nothing
+struct NoObserver {
+    void started(const std::vector<uint32_t>&) {}
+    void splitterChosen(uint32_t, size_t) {}
+    void blockSplit(uint32_t, uint32_t, const uint32_t*, const uint32_t*) {}
+    void symbolDone(uint32_t) {}
+    void finished(uint32_t) {}
+    constexpr bool cancelled() const { return false; }
+};
+
+// Leaves the coarsest stable partition in ws.partition
+template <class Observer>
+void refineWith(const CompactDFA& dfa, Observer& observer, HopcroftWorkspace& ws) {
+    const uint32_t n = dfa.numStates();
+    const uint32_t k = dfa.numSymbols();
+    RefinablePartition& P = ws.partition;
+    P.init(n);
+    if (n == 0) return;
+
+    // Inverse transitions grouped by (symbol, target): the predecessors of q
+    // under c are inv[invStart[c*n + q] .. invStart[c*n + q + 1])
+    std::vector<uint32_t>& invStart = ws.invStart;
+    invStart.assign(size_t(n) * k + 1, 0);
+    for (uint32_t q = 0; q < n; ++q) {
+        const uint32_t* r = dfa.row(q);
+        for (uint32_t c = 0; c < k; ++c) {
+            if (r[c] != CompactDFA::NONE) ++invStart[size_t(c) * n + r[c]];
         }
     }
-    
-    // Construct minimized DFA
-    DFA minDFA;
-    minDFA.alphabet = dfa.alphabet;
-    
-    // Create states for each block
-    int blockIdx = 0;
-    std::map<std::string, std::string> oldToNew; // oldId -> newId
-    
-    // Calculate somewhat smart positions
-    double centerX = 400;
-    double centerY = 300;
-    double radius = 200;
-    int totalBlocks = P.size();
-
-    for (const auto& block : P) {
-        std::string newId = "{" + (*block.begin()) + (block.size()>1 ? ".." : "") + "}";
-        // Simplified naming or just q0', q1' could be better but let's use list rep for debug
-        // For cleaner ID, let's use q_0, q_1...
-        // But let's try to preserve meaningful names if possible.
-        // Actually, let's just name them Q0, Q1...
-        std::string finalId = "Q" + std::to_string(blockIdx);
-        
-        bool isStart = false;
-        bool isAccept = false;
-        
-        for (const auto& oldId : block) {
-            const DFAState* s = dfa.getState(oldId);
-            if (s && s->isStart) isStart = true;
-            if (s && s->isAccept) isAccept = true;
-            oldToNew[oldId] = finalId;
+    for (size_t i = 1; i < invStart.size(); ++i) invStart[i] += invStart[i - 1];
+    std::vector<uint32_t>& inv = ws.inv;
+    inv.resize(invStart.back());
+    for (uint32_t q = n; q-- > 0;) {
+        const uint32_t* r = dfa.row(q);
+        for (uint32_t c = 0; c < k; ++c) {
+            if (r[c] != CompactDFA::NONE) inv[--invStart[size_t(c) * n + r[c]]] = q;
         }
-        
-        double angle = (2 * 3.14159 * blockIdx) / totalBlocks;
-        minDFA.addState(finalId, isStart, isAccept, 
-                        centerX + radius * cos(angle), 
-                        centerY + radius * sin(angle));
-        blockIdx++;
     }
-    
-    // Add transitions
-    // Since it's a partition, taking any representative from block is enough
-    for (const auto& block : P) {
-        if (block.empty()) continue;
-        std::string rep = *block.begin(); // Representative
-        std::string fromNew = oldToNew[rep];
-        
-        for (const auto& c : minDFA.alphabet) {
-            if (dfa.transitions.count({rep, c})) {
-                std::string toOld = dfa.transitions.at({rep, c});
-                std::string toNew = oldToNew[toOld];
-                minDFA.addTransition(fromNew, c, toNew);
+
+    // P = {F, Q\F}
+    for (uint32_t q = 0; q < n; ++q) {
+        if (dfa.isAccept(q)) P.mark(q);
+    }
+    P.split();
+    observer.started(P.blocks());
+
+    // W starts with every block: with partial transitions, stability under
+    // one block does not imply stability under its complement.
+    // A split always gives the new id to the smaller half, so pushing it is
+    // right both when the old block is still in W and when it is not.
+    std::vector<uint32_t>& W = ws.worklist;
+    W.clear();
+    for (uint32_t b = 0; b < P.numBlocks(); ++b) W.push_back(b);
+
+    std::vector<uint32_t>& splitter = ws.splitter;
+    while (!W.empty() && !observer.cancelled()) {
+        uint32_t A = W.back();
+        W.pop_back();
+        // Snapshot: A itself may split while we go through the symbols
+        splitter.assign(P.begin(A), P.end(A));
+        observer.splitterChosen(A, W.size());
+
+        for (uint32_t c = 0; c < k; ++c) {
+            const uint32_t* start = invStart.data() + size_t(c) * n;
+            for (uint32_t q : splitter) {
+                for (uint32_t i = start[q]; i < start[q + 1]; ++i) P.mark(inv[i]);
             }
+            P.split([&](uint32_t b, uint32_t z) {
+                W.push_back(z);
+                observer.blockSplit(b, z, P.begin(z), P.end(z));
+            });
+            observer.symbolDone(c);
+        }
+    }
+
+    observer.finished(P.numBlocks());
+}
+
+// Block ids renumbered in order of their first state, like Quotient::canonicalize.
+// With reached, states outside it get NONE and do not count.
+uint32_t canonicalClasses(HopcroftWorkspace& ws, const Bitset* reached, std::vector<uint32_t>& classOf) {
+    const RefinablePartition& P = ws.partition;
+    const uint32_t n = uint32_t(P.blocks().size());
+    ws.renumber.assign(P.numBlocks(), CompactDFA::NONE);
+    classOf.resize(n);
+    uint32_t count = 0;
+    for (uint32_t q = 0; q < n; ++q) {
+        if (reached && !reached->test(q)) {
+            classOf[q] = CompactDFA::NONE;
+            continue;
         }
+        uint32_t& c = ws.renumber[P.blockOf(q)];
+        if (c == CompactDFA::NONE) c = count++;
+        classOf[q] = c;
     }
-    
-    return {minDFA, history};
+    return count;
+}
+
+} // namespace
+
+void HopcroftWorkspace::reserve(uint32_t n, uint32_t k) {
+    invStart.reserve(size_t(n) * k + 1);
+    inv.reserve(size_t(n) * k);
+    partition.reserve(n);
+    // Every block enters the worklist at most once
+    worklist.reserve(n);
+    splitter.reserve(n);
+    renumber.reserve(n);
+    reached.resize(n);
+    frontier.reserve(n);
+}
+
+uint32_t Hopcroft::refine(const CompactDFA& dfa, std::vector<uint32_t>& classOf) {
+    HopcroftWorkspace ws;
+    return refine(dfa, classOf, ws);
+}
+
+uint32_t Hopcroft::refine(const CompactDFA& dfa, std::vector<uint32_t>& classOf, HopcroftObserver& observer) {
+    HopcroftWorkspace ws;
+    refineWith(dfa, observer, ws);
+    return canonicalClasses(ws, nullptr, classOf);
+}
+
+uint32_t Hopcroft::refine(const CompactDFA& dfa, std::vector<uint32_t>& classOf, HopcroftWorkspace& ws) {
+    NoObserver none;
+    refineWith(dfa, none, ws);
+    return canonicalClasses(ws, nullptr, classOf);
+}
+
+uint32_t Hopcroft::minimize(const CompactDFA& dfa, std::vector<uint32_t>& classOf, HopcroftWorkspace& ws) {
+    // Refining all states gives the reachable ones the same classes as
+    // refining the reachable part: a state's class depends only on the
+    // states it reaches. This saves copying the reachable part.
+    NoObserver none;
+    refineWith(dfa, none, ws);
+    dfa.reachable(ws.reached, ws.frontier);
+    return canonicalClasses(ws, &ws.reached, classOf);
+}
+
+CompactDFA Hopcroft::minimize(const CompactDFA& dfa, HopcroftWorkspace& ws) {
+    std::vector<uint32_t> classOf;
+    uint32_t numClasses = minimize(dfa, classOf, ws);
+    return Quotient::build(dfa, classOf, numClasses);
+}
+
+CompactDFA Hopcroft::minimize(const CompactDFA& dfa) {
+    HopcroftWorkspace ws;
+    return minimize(dfa, ws);
+}
+
+CompactDFA Hopcroft::minimize(const CompactDFA& dfa, HopcroftObserver& observer) {
+    CompactDFA reachable = dfa.reachablePart();
+    std::vector<uint32_t> classOf;
+    uint32_t numClasses = refine(reachable, classOf, observer);
+    return Quotient::build(reachable, classOf, numClasses);
+}
+
+std::pair<DFA, HopcroftTimeline> Hopcroft::minimize(const DFA& inputDFA, TraceLevel level) {
+    if (level == TraceLevel::None) return {minimizeFast(inputDFA), HopcroftTimeline()};
+    HopcroftRecorder recorder(level);
+    return minimize(inputDFA, recorder);
+}
+
+std::pair<DFA, HopcroftTimeline> Hopcroft::minimize(const DFA& inputDFA, HopcroftRecorder& recorder) {
+    CompactDFA reachable = CompactDFA::fromDFA(inputDFA).reachablePart();
+    std::vector<uint32_t> classOf;
+    uint32_t numClasses = refine(reachable, classOf, recorder);
+    DFA minDFA = Quotient::build(reachable, classOf, numClasses).toDFA();
+    minDFA.alphabet = inputDFA.alphabet;
+    return {minDFA, HopcroftTimeline(std::move(reachable), recorder.takeTrace())};
+}
+
+DFA Hopcroft::minimizeFast(const DFA& inputDFA) {
+    DFA minDFA = minimize(CompactDFA::fromDFA(inputDFA)).toDFA();
+    minDFA.alphabet = inputDFA.alphabet;
+    return minDFA;
 }
\ No newline at end of file
@@ -1,26 +1,58 @@
 #pragma once
 #include "../model/DFA.h"
+#include "../model/CompactDFA.h"
+#include "HopcroftTrace.h"
+#include "Partition.h"
+#include <utility>
 #include <vector>
-#include <string>
-#include <set>
 
-struct HopcroftSplit {
-    std::set<std::string> Y;
-    std::set<std::string> Y_intersect_X;
-    std::set<std::string> Y_minus_X;
-};
+// Working memory of a Hopcroft run, kept between runs. Buffers only grow, so
+// once a workspace has seen an automaton of a given size (or reserve() was
+// called for it) later runs on automata up to that size allocate nothing.
+// One workspace per thread.
+struct HopcroftWorkspace {
+    // Sizes every buffer for n states over k symbols up front
+    void reserve(uint32_t n, uint32_t k);
 
-struct HopcroftStep {
-    std::vector<std::set<std::string>> partitionsBefore;
-    std::vector<std::set<std::string>> partitionsAfter;
-    std::set<std::string> A; // The splitter set chosen from W
-    std::string symbol;      // The symbol c
-    std::set<std::string> X; // Preimage of A under c
-    std::vector<HopcroftSplit> splits;
-    std::string explanation;
+    std::vector<uint32_t> invStart; // inverse transitions, see refine()
+    std::vector<uint32_t> inv;
+    RefinablePartition partition;
+    std::vector<uint32_t> worklist;
+    std::vector<uint32_t> splitter;
+    std::vector<uint32_t> renumber; // block -> canonical class
+    Bitset reached;
+    std::vector<uint32_t> frontier;
 };
 
 class Hopcroft {
 public:
-    static std::pair<DFA, std::vector<HopcroftStep>> minimize(const DFA& inputDFA);
+    // Minimizes and records the step timeline the GUI replays; with
+    // TraceLevel::None the timeline stays empty, Summary fills only its stats
+    static std::pair<DFA, HopcroftTimeline> minimize(const DFA& inputDFA, TraceLevel level = TraceLevel::Full);
+    // Same, recording through the given recorder (e.g. one that also reports progress)
+    static std::pair<DFA, HopcroftTimeline> minimize(const DFA& inputDFA, HopcroftRecorder& recorder);
+
+    // Same result as minimize(), without the step history, in O(n·|Σ|·log n):
+    // inverse transition lists, a refinable partition and a worklist of block ids.
+    static DFA minimizeFast(const DFA& inputDFA);
+    static CompactDFA minimize(const CompactDFA& dfa);
+    static CompactDFA minimize(const CompactDFA& dfa, HopcroftObserver& observer);
+    // Same result, with the working memory drawn from ws; only the returned
+    // automaton is allocated
+    static CompactDFA minimize(const CompactDFA& dfa, HopcroftWorkspace& ws);
+    // The minimal automaton as a partition, without building it: classOf[q] is
+    // q's state in minimize(dfa) when q is reachable, NONE otherwise. Returns
+    // the number of states. No allocation once ws and classOf have grown to
+    // the automaton's size.
+    static uint32_t minimize(const CompactDFA& dfa, std::vector<uint32_t>& classOf, HopcroftWorkspace& ws);
+
+    // Coarsest partition of all states (no trimming) that separates accepting
+    // from non-accepting states and is stable under every symbol; a missing
+    // transition only agrees with another missing transition. Fills classOf in
+    // Quotient::canonicalize order and returns the number of classes.
+    static uint32_t refine(const CompactDFA& dfa, std::vector<uint32_t>& classOf);
+    // Same, reporting every step to observer as it happens
+    static uint32_t refine(const CompactDFA& dfa, std::vector<uint32_t>& classOf, HopcroftObserver& observer);
+    // Same, with the working memory drawn from ws
+    static uint32_t refine(const CompactDFA& dfa, std::vector<uint32_t>& classOf, HopcroftWorkspace& ws);
 };
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "HopcroftTrace.h"
+#include <algorithm>
+
+void HopcroftTrace::clear() {
+    initial.clear();
+    splits.clear();
+    moved.clear();
+    steps.clear();
+    stats = HopcroftStats();
+}
+
+void HopcroftRecorder::started(const std::vector<uint32_t>& blockOf) {
+    m_trace.clear();
+    if (m_level == TraceLevel::Full) m_trace.initial = blockOf;
+}
+
+void HopcroftRecorder::splitterChosen(uint32_t block, size_t worklist) {
+    ++m_trace.stats.splitters;
+    m_trace.stats.maxWorklist = std::max(m_trace.stats.maxWorklist, worklist + 1);
+    m_splitter = block;
+    m_version = uint32_t(m_trace.splits.size());
+    m_firstSplit = m_version;
+    m_splitsBefore = m_trace.stats.splits;
+}
+
+void HopcroftRecorder::blockSplit(uint32_t block, uint32_t newBlock, const uint32_t* moved, const uint32_t* movedEnd) {
+    ++m_trace.stats.splits;
+    m_trace.stats.moved += uint64_t(movedEnd - moved);
+    if (m_level != TraceLevel::Full) return;
+    uint32_t movedBegin = uint32_t(m_trace.moved.size());
+    m_trace.moved.insert(m_trace.moved.end(), moved, movedEnd);
+    m_trace.splits.push_back({block, newBlock, movedBegin, uint32_t(m_trace.moved.size())});
+}
+
+void HopcroftRecorder::symbolDone(uint32_t symbol) {
+    if (m_trace.stats.splits == m_splitsBefore) return;
+    ++m_trace.stats.steps;
+    m_splitsBefore = m_trace.stats.splits;
+    if (m_level != TraceLevel::Full) return;
+    uint32_t end = uint32_t(m_trace.splits.size());
+    m_trace.steps.push_back({m_splitter, m_version, symbol, m_firstSplit, end - m_firstSplit});
+    m_firstSplit = end;
+}
+
+void HopcroftRecorder::finished(uint32_t numBlocks) {
+    m_trace.stats.blocks = numBlocks;
+}
+
+HopcroftTimeline::HopcroftTimeline(CompactDFA dfa, HopcroftTrace trace, uint32_t checkpointInterval)
+    : m_dfa(std::move(dfa)), m_trace(std::move(trace)), m_interval(std::max(checkpointInterval, 1u)) {
+    m_checkpoints.resize((m_trace.steps.size() + m_interval - 1) / m_interval);
+    m_current = m_trace.initial;
+}
+
+void HopcroftTimeline::apply(std::vector<uint32_t>& blockOf, uint32_t from, uint32_t to) const {
+    for (uint32_t v = from; v < to; ++v) {
+        const auto& s = m_trace.splits[v];
+        for (uint32_t i = s.movedBegin; i < s.movedEnd; ++i) blockOf[m_trace.moved[i]] = s.newBlock;
+    }
+}
+
+std::vector<uint32_t> HopcroftTimeline::partitionAt(uint32_t version) const {
+    version = std::min(version, uint32_t(m_trace.splits.size()));
+    // Checkpoint j sits at the version before step j * interval; versions grow with j
+    auto checkpointVersion = [&](size_t j) { return m_trace.steps[j * m_interval].firstSplit; };
+    size_t lo = 0, hi = m_checkpoints.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (checkpointVersion(mid) <= version) lo = mid + 1;
+        else hi = mid;
+    }
+    size_t reached = lo; // checkpoints [0, reached) are at or below version
+
+    // Forward from where we are if nothing better is closer, else restart
+    // from the nearest stored checkpoint (checkpoint 0 is the initial partition)
+    bool canContinue = m_currentVersion <= version && (reached == 0 || m_currentVersion >= checkpointVersion(reached - 1));
+    if (!canContinue) {
+        size_t j = reached - 1;
+        while (j > 0 && m_checkpoints[j].empty()) --j;
+        m_current = j == 0 ? m_trace.initial : m_checkpoints[j];
+        m_currentVersion = j == 0 ? 0 : checkpointVersion(j);
+    }
+
+    size_t next = 0;
+    while (next < m_checkpoints.size() && checkpointVersion(next) <= m_currentVersion) ++next;
+    for (; next < reached; ++next) {
+        apply(m_current, m_currentVersion, checkpointVersion(next));
+        m_currentVersion = checkpointVersion(next);
+        if (m_checkpoints[next].empty()) m_checkpoints[next] = m_current;
+    }
+    apply(m_current, m_currentVersion, version);
+    m_currentVersion = version;
+    return m_current;
+}
+
+std::vector<uint32_t> HopcroftTimeline::after(size_t step) const {
+    const auto& s = m_trace.steps[step];
+    return partitionAt(s.firstSplit + s.numSplits);
+}
+
+std::vector<uint32_t> HopcroftTimeline::splitter(size_t step) const {
+    const auto& s = m_trace.steps[step];
+    const std::vector<uint32_t> blockOf = partitionAt(s.splitterVersion);
+    std::vector<uint32_t> members;
+    for (uint32_t q = 0; q < blockOf.size(); ++q) {
+        if (blockOf[q] == s.splitter) members.push_back(q);
+    }
+    return members;
+}
+
+std::vector<uint32_t> HopcroftTimeline::preimage(size_t step) const {
+    std::vector<char> inA(m_dfa.numStates(), 0);
+    for (uint32_t q : splitter(step)) inA[q] = 1;
+    const uint32_t c = m_trace.steps[step].symbol;
+    std::vector<uint32_t> members;
+    for (uint32_t q = 0; q < m_dfa.numStates(); ++q) {
+        uint32_t t = m_dfa.next(q, c);
+        if (t != CompactDFA::NONE && inA[t]) members.push_back(q);
+    }
+    return members;
+}
+
+std::vector<uint32_t> HopcroftTimeline::splitBlocks(size_t step) const {
+    const auto& s = m_trace.steps[step];
+    std::vector<char> split(m_trace.initial.size(), 0); // block ids are below n
+    for (uint32_t i = s.firstSplit; i < s.firstSplit + s.numSplits; ++i) split[m_trace.splits[i].block] = 1;
+    const std::vector<uint32_t> blockOf = before(step);
+    std::vector<uint32_t> members;
+    for (uint32_t q = 0; q < blockOf.size(); ++q) {
+        if (split[blockOf[q]]) members.push_back(q);
+    }
+    return members;
+}
+
+std::string HopcroftTimeline::explanation(size_t step) const {
+    const auto& s = m_trace.steps[step];
+    return "Refining partition with respect to set A and symbol '" + m_dfa.symbol(s.symbol) + "'. "
+         + std::to_string(s.numSplits) + " blocks were split.";
+}
\ No newline at end of file
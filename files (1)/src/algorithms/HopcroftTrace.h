@@ -0,0 +1,135 @@
+#pragma once
+#include "../model/CompactDFA.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// How much of a run to record
+enum class TraceLevel {
+    None,    // nothing; the refinement loop carries no tracing code at all
+    Summary, // HopcroftStats counters only
+    Full     // every split, for the step timeline
+};
+
+// Hooks into Hopcroft::refine. Calls arrive in run order from the calling
+// thread; a run without an observer is compiled without any of them.
+class HopcroftObserver {
+public:
+    virtual ~HopcroftObserver() = default;
+    // Partition {F, Q\F} as block ids, before any splitter is processed
+    virtual void started(const std::vector<uint32_t>& blockOf) { (void)blockOf; }
+    // Block A taken from the worklist; worklist is the size left after taking it
+    virtual void splitterChosen(uint32_t block, size_t worklist) { (void)block; (void)worklist; }
+    // block lost the states [moved, movedEnd) to the new block newBlock
+    virtual void blockSplit(uint32_t block, uint32_t newBlock, const uint32_t* moved, const uint32_t* movedEnd) {
+        (void)block; (void)newBlock; (void)moved; (void)movedEnd;
+    }
+    // Every split caused by (A, symbol) has been reported
+    virtual void symbolDone(uint32_t symbol) { (void)symbol; }
+    virtual void finished(uint32_t numBlocks) { (void)numBlocks; }
+    // Polled before every splitter; true stops the run early, leaving a
+    // partition that is not yet stable (the result is then not minimal)
+    virtual bool cancelled() { return false; }
+};
+
+struct HopcroftStats {
+    uint64_t splitters = 0;   // blocks taken from the worklist
+    uint64_t steps = 0;       // (splitter, symbol) pairs that split something
+    uint64_t splits = 0;
+    uint64_t moved = 0;       // states moved to new blocks, summed over splits
+    size_t maxWorklist = 0;
+    uint32_t blocks = 0;      // final number of blocks
+};
+
+// Compact record of a Hopcroft run over integer state ids. Instead of
+// snapshots it keeps the initial partition plus every block split in order,
+// so the whole history costs O(n log n) integers: a split only lists the
+// states that moved, and those are always the smaller half.
+struct HopcroftTrace {
+    struct Split {
+        uint32_t block;      // block that split
+        uint32_t newBlock;   // id given to the part that left it
+        uint32_t movedBegin; // the states that moved: moved[movedBegin, movedEnd)
+        uint32_t movedEnd;
+    };
+    // One (splitter, symbol) pair that split at least one block
+    struct Step {
+        uint32_t splitter;        // block A, as it was at partition version splitterVersion
+        uint32_t splitterVersion;
+        uint32_t symbol;
+        uint32_t firstSplit;      // splits[firstSplit, firstSplit + numSplits)
+        uint32_t numSplits;
+    };
+
+    std::vector<uint32_t> initial; // block of every state in {F, Q\F}
+    std::vector<Split> splits;     // partition version v = initial plus the first v splits
+    std::vector<uint32_t> moved;
+    std::vector<Step> steps;
+    HopcroftStats stats;
+
+    void clear();
+};
+
+// Observer that fills a HopcroftTrace up to the given level
+class HopcroftRecorder : public HopcroftObserver {
+public:
+    explicit HopcroftRecorder(TraceLevel level = TraceLevel::Full) : m_level(level) {}
+
+    const HopcroftTrace& trace() const { return m_trace; }
+    HopcroftTrace takeTrace() { return std::move(m_trace); }
+
+    void started(const std::vector<uint32_t>& blockOf) override;
+    void splitterChosen(uint32_t block, size_t worklist) override;
+    void blockSplit(uint32_t block, uint32_t newBlock, const uint32_t* moved, const uint32_t* movedEnd) override;
+    void symbolDone(uint32_t symbol) override;
+    void finished(uint32_t numBlocks) override;
+
+private:
+    TraceLevel m_level;
+    HopcroftTrace m_trace;
+    uint32_t m_splitter = 0;
+    uint32_t m_version = 0;
+    uint32_t m_firstSplit = 0;
+    uint64_t m_splitsBefore = 0;
+};
+
+// Timeline view of a trace: rebuilds the partition at any step on demand.
+// Every checkpointInterval steps the partition is kept once it has been
+// visited, so jumping around replays at most that many steps; moving to the
+// next or previous step replays one. The replay cursor is shared state, so
+// even the const queries must not be called from two threads at once.
+class HopcroftTimeline {
+public:
+    HopcroftTimeline() = default;
+    // dfa is the automaton the run refined (the reachable part of the input)
+    HopcroftTimeline(CompactDFA dfa, HopcroftTrace trace, uint32_t checkpointInterval = 64);
+
+    bool empty() const { return m_trace.steps.empty(); }
+    size_t numSteps() const { return m_trace.steps.size(); }
+    const HopcroftTrace::Step& step(size_t i) const { return m_trace.steps[i]; }
+    const HopcroftTrace& trace() const { return m_trace; }
+    const CompactDFA& dfa() const { return m_dfa; }
+
+    // Block of every state after the first `version` splits; a copy, so
+    // before(i) and after(i) can be held side by side
+    std::vector<uint32_t> partitionAt(uint32_t version) const;
+    std::vector<uint32_t> before(size_t step) const { return partitionAt(m_trace.steps[step].firstSplit); }
+    std::vector<uint32_t> after(size_t step) const;
+
+    std::vector<uint32_t> splitter(size_t step) const; // A
+    std::vector<uint32_t> preimage(size_t step) const; // X: states whose symbol transition lands in A
+    std::vector<uint32_t> splitBlocks(size_t step) const; // members of every block Y the step split
+    std::string explanation(size_t step) const;
+
+private:
+    void apply(std::vector<uint32_t>& blockOf, uint32_t from, uint32_t to) const;
+
+    CompactDFA m_dfa;
+    HopcroftTrace m_trace;
+    uint32_t m_interval = 64;
+    // checkpoint j: partition before step j * m_interval (empty until visited)
+    mutable std::vector<std::vector<uint32_t>> m_checkpoints;
+    mutable std::vector<uint32_t> m_current;
+    mutable uint32_t m_currentVersion = 0;
+};
\ No newline at end of file
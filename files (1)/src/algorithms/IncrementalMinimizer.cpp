@@ -0,0 +1,101 @@
+#include "IncrementalMinimizer.h"
+#include "Quotient.h"
+
+void IncrementalMinimizer::reset() {
+    m_hasBaseline = false;
+    m_base.clear();
+    m_classOf.clear();
+    m_numClasses = 0;
+    m_stats = Stats();
+}
+
+CompactDFA IncrementalMinimizer::minimize(const CompactDFA& dfa) {
+    std::vector<uint32_t> identity(dfa.numStates());
+    for (uint32_t q = 0; q < dfa.numStates(); ++q) identity[q] = q;
+    m_stats = Stats();
+    m_stats.reduced = dfa.numStates();
+    return finish(dfa, dfa, identity);
+}
+
+CompactDFA IncrementalMinimizer::update(const CompactDFA& edited, const std::vector<DFAEdit>& journal) {
+    if (!m_hasBaseline || edited.symbols() != m_base.symbols()) return minimize(edited);
+    for (const auto& e : journal) {
+        if (e.kind == DFAEdit::AlphabetChanged || e.kind == DFAEdit::Reloaded) return minimize(edited);
+    }
+
+    // Edited states: journaled ones, plus any the baseline has no class for
+    const uint32_t n = edited.numStates();
+    const uint32_t k = edited.numSymbols();
+    Bitset dirty(n);
+    std::vector<uint32_t> baseIndex(n);
+    for (uint32_t q = 0; q < n; ++q) {
+        uint32_t b = m_base.stateIndex(edited.stateId(q));
+        baseIndex[q] = b;
+        if (b == CompactDFA::NONE || m_classOf[b] == CompactDFA::NONE) dirty.set(q);
+    }
+    for (const auto& e : journal) {
+        if (e.kind == DFAEdit::StateRemoved || e.kind == DFAEdit::StartChanged) continue;
+        uint32_t q = edited.stateIndex(e.state);
+        if (q != CompactDFA::NONE) dirty.set(q);
+    }
+
+    // Only states that can reach an edit may have a different language now
+    Bitset cone = edited.canReach(dirty);
+    Stats stats;
+    stats.incremental = true;
+    stats.dirty = uint32_t(dirty.count());
+    stats.cone = uint32_t(cone.count());
+    if (size_t(stats.cone) * 2 > n) {
+        CompactDFA result = minimize(edited);
+        m_stats.dirty = stats.dirty;
+        m_stats.cone = stats.cone;
+        return result;
+    }
+
+    // One node per cone state and one per old class outside the cone. States
+    // outside the cone only lead to states outside it, so a class node can
+    // take its transitions from any member.
+    CompactDFA reduced;
+    reduced.reserve(stats.cone + m_numClasses, k);
+    for (const auto& sym : edited.symbols()) reduced.addSymbol(sym);
+    const uint32_t start = edited.startState();
+    std::vector<uint32_t> nodeOf(n);
+    std::vector<uint32_t> nodeOfClass(m_numClasses, CompactDFA::NONE);
+    std::vector<uint32_t> member;
+    for (uint32_t q = 0; q < n; ++q) {
+        uint32_t* shared = cone.test(q) ? nullptr : &nodeOfClass[m_classOf[baseIndex[q]]];
+        if (shared && *shared != CompactDFA::NONE) {
+            nodeOf[q] = *shared;
+            if (q == start) reduced.setStart(*shared, true);
+            continue;
+        }
+        nodeOf[q] = reduced.addState(edited.stateId(q), q == start, edited.isAccept(q), edited.x(q), edited.y(q));
+        if (shared) *shared = nodeOf[q];
+        member.push_back(q);
+    }
+    for (uint32_t r = 0; r < reduced.numStates(); ++r) {
+        const uint32_t* row = edited.row(member[r]);
+        for (uint32_t a = 0; a < k; ++a) {
+            if (row[a] != CompactDFA::NONE) reduced.setTransition(r, a, nodeOf[row[a]]);
+        }
+    }
+
+    stats.reduced = reduced.numStates();
+    CompactDFA result = finish(edited, reduced, nodeOf);
+    m_stats = stats;
+    return result;
+}
+
+CompactDFA IncrementalMinimizer::finish(const CompactDFA& input, const CompactDFA& reduced,
+                                        const std::vector<uint32_t>& nodeOf) {
+    std::vector<uint32_t> classOf;
+    m_numClasses = Hopcroft::minimize(reduced, classOf, m_workspace);
+    CompactDFA result = Quotient::build(reduced, classOf, m_numClasses);
+
+    // Compose input -> reduced -> class; unreachable nodes have class NONE
+    m_classOf.resize(input.numStates());
+    for (uint32_t q = 0; q < input.numStates(); ++q) m_classOf[q] = classOf[nodeOf[q]];
+    m_base = input;
+    m_hasBaseline = true;
+    return result;
+}
\ No newline at end of file
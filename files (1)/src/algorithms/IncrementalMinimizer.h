@@ -0,0 +1,60 @@
+#pragma once
+#include "../model/CompactDFA.h"
+#include "Hopcroft.h"
+#include <string>
+#include <vector>
+
+// One entry of the editor's edit journal
+struct DFAEdit {
+    enum Kind {
+        StateAdded,
+        StateRemoved,       // the sources of its incoming transitions are journaled separately
+        AcceptChanged,
+        StartChanged,
+        TransitionsChanged, // outgoing transitions of state
+        AlphabetChanged,    // forces a full run
+        Reloaded            // automaton replaced; the journal no longer describes a diff
+    };
+    Kind kind;
+    std::string state;
+};
+
+// Hopcroft minimization that remembers its last input and the state -> class
+// map proving which states are equivalent. After a few edits only the states
+// that can reach an edited state may change class; every other state keeps
+// its language, so its old class stands in for it. The next run minimizes
+// those classes plus the edited states' backward cone instead of the whole
+// automaton. The result is the same automaton a full run gives (up to the
+// order of its states).
+class IncrementalMinimizer {
+public:
+    struct Stats {
+        bool incremental = false; // false when the last run started from scratch
+        uint32_t dirty = 0;       // edited states
+        uint32_t cone = 0;        // states that can reach an edited state
+        uint32_t reduced = 0;     // states actually minimized
+    };
+
+    // Full run; becomes the baseline for update()
+    CompactDFA minimize(const CompactDFA& dfa);
+    // Minimizes edited, which is the baseline changed as journal describes.
+    // Falls back to a full run without a baseline, on AlphabetChanged or
+    // Reloaded, or when the cone covers most of the automaton.
+    CompactDFA update(const CompactDFA& edited, const std::vector<DFAEdit>& journal);
+
+    bool hasBaseline() const { return m_hasBaseline; }
+    void reset();
+    const Stats& lastRun() const { return m_stats; }
+
+private:
+    // Minimizes reduced, whose state r stands for the states q with nodeOf[q] == r,
+    // and records input as the new baseline
+    CompactDFA finish(const CompactDFA& input, const CompactDFA& reduced, const std::vector<uint32_t>& nodeOf);
+
+    bool m_hasBaseline = false;
+    CompactDFA m_base;               // last input
+    std::vector<uint32_t> m_classOf; // class of each m_base state in the last result; NONE = none
+    uint32_t m_numClasses = 0;
+    HopcroftWorkspace m_workspace;
+    Stats m_stats;
+};
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "Minimizer.h"
+#include "AlphabetClasses.h"
+#include "Hopcroft.h"
+#include "Valmari.h"
+#include "ParallelMoore.h"
+
+CompactDFA Minimizer::minimize(const CompactDFA& dfa, const MinimizerOptions& options) {
+    if (options.compressAlphabet && !options.observer) {
+        AlphabetClasses classes = AlphabetClasses::of(dfa);
+        if (classes.numClasses() < dfa.numSymbols()) {
+            MinimizerOptions narrow = options;
+            narrow.compressAlphabet = false;
+            return classes.expand(minimize(classes.compress(dfa), narrow), dfa);
+        }
+    }
+    switch (options.algorithm) {
+    case MinimizerAlgorithm::Valmari:
+        return Valmari::minimize(dfa);
+    case MinimizerAlgorithm::ParallelMoore:
+        return ParallelMoore::minimize(dfa, options.threads);
+    case MinimizerAlgorithm::Hopcroft:
+    default:
+        return options.observer ? Hopcroft::minimize(dfa, *options.observer) : Hopcroft::minimize(dfa);
+    }
+}
+
+DFA Minimizer::minimize(const DFA& dfa, const MinimizerOptions& options) {
+    DFA minDFA = minimize(CompactDFA::fromDFA(dfa), options).toDFA();
+    minDFA.alphabet = dfa.alphabet;
+    return minDFA;
+}
+
+const char* Minimizer::name(MinimizerAlgorithm algorithm) {
+    switch (algorithm) {
+    case MinimizerAlgorithm::Valmari: return "valmari";
+    case MinimizerAlgorithm::ParallelMoore: return "parallel";
+    case MinimizerAlgorithm::Hopcroft:
+    default: return "hopcroft";
+    }
+}
+
+bool Minimizer::parse(const std::string& name, MinimizerAlgorithm& algorithm) {
+    for (auto a : {MinimizerAlgorithm::Hopcroft, MinimizerAlgorithm::Valmari, MinimizerAlgorithm::ParallelMoore}) {
+        if (name == Minimizer::name(a)) {
+            algorithm = a;
+            return true;
+        }
+    }
+    return false;
+}
\ No newline at end of file
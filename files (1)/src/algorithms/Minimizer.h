@@ -0,0 +1,32 @@
+#pragma once
+#include "../model/DFA.h"
+#include "../model/CompactDFA.h"
+
+class HopcroftObserver;
+
+enum class MinimizerAlgorithm {
+    Hopcroft, // O(n·|Σ|·log n); a missing transition is only equivalent to another missing one
+    Valmari,  // O(m log n) on partial DFAs; missing transitions mean "reject", no sink needed
+    ParallelMoore // multi-threaded Moore rounds; same result as Hopcroft
+};
+
+struct MinimizerOptions {
+    MinimizerAlgorithm algorithm = MinimizerAlgorithm::Hopcroft;
+    unsigned threads = 0; // ParallelMoore only; 0 = all hardware threads
+    HopcroftObserver* observer = nullptr; // Hopcroft only; see TraceLevel
+    // Minimize over AlphabetClasses (symbols with equal columns as one) and
+    // restore the symbols afterwards. Skipped with an observer, whose steps
+    // name the symbols they split on.
+    bool compressAlphabet = true;
+};
+
+// Single entry point for picking a minimization engine at run time
+class Minimizer {
+public:
+    static CompactDFA minimize(const CompactDFA& dfa, const MinimizerOptions& options = {});
+    static DFA minimize(const DFA& dfa, const MinimizerOptions& options = {});
+
+    static const char* name(MinimizerAlgorithm algorithm);
+    // Accepts the names returned by name(); returns false for anything else
+    static bool parse(const std::string& name, MinimizerAlgorithm& algorithm);
+};
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "ParallelMoore.h"
+#include "Quotient.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// Runs fn(begin, end) over [0, n) split into one contiguous chunk per thread
+template <class F>
+void parallelFor(unsigned threads, uint32_t n, F&& fn) {
+    if (threads <= 1 || n < 4096) {
+        fn(uint32_t(0), n);
+        return;
+    }
+    std::vector<std::thread> pool;
+    uint32_t chunk = (n + threads - 1) / threads;
+    for (unsigned t = 0; t < threads; ++t) {
+        uint32_t begin = std::min(n, t * chunk);
+        uint32_t end = std::min(n, begin + chunk);
+        if (begin == end) break;
+        pool.emplace_back([&fn, begin, end] { fn(begin, end); });
+    }
+    for (auto& th : pool) th.join();
+}
+
+inline uint64_t mix(uint64_t h, uint64_t v) {
+    h ^= v + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+    return h * 0xFF51AFD7ED558CCDULL;
+}
+
+} // namespace
+
+uint32_t ParallelMoore::refine(const CompactDFA& dfa, std::vector<uint32_t>& classOf, unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const uint32_t n = dfa.numStates();
+    const uint32_t k = dfa.numSymbols();
+    classOf.assign(n, 0);
+    if (n == 0) return 0;
+
+    std::vector<uint32_t> block(n), nextBlock(n), order(n), scratch(n);
+    std::vector<uint64_t> hash(n);
+    uint32_t numBlocks = 0;
+    {
+        bool any[2] = {false, false};
+        for (uint32_t q = 0; q < n; ++q) {
+            block[q] = dfa.isAccept(q) ? 1 : 0;
+            any[block[q]] = true;
+        }
+        numBlocks = uint32_t(any[0]) + uint32_t(any[1]);
+    }
+
+    // Missing transitions map to NONE, so they only agree with each other
+    auto succ = [&](uint32_t q, uint32_t a) {
+        uint32_t t = dfa.next(q, a);
+        return t == CompactDFA::NONE ? CompactDFA::NONE : block[t];
+    };
+    auto less = [&](uint32_t p, uint32_t q) {
+        if (hash[p] != hash[q]) return hash[p] < hash[q];
+        if (block[p] != block[q]) return block[p] < block[q];
+        for (uint32_t a = 0; a < k; ++a) {
+            uint32_t sp = succ(p, a), sq = succ(q, a);
+            if (sp != sq) return sp < sq;
+        }
+        return false;
+    };
+    auto same = [&](uint32_t p, uint32_t q) { return !less(p, q) && !less(q, p); };
+
+    while (true) {
+        parallelFor(threads, n, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t q = begin; q < end; ++q) {
+                uint64_t h = mix(0, block[q]);
+                for (uint32_t a = 0; a < k; ++a) h = mix(h, succ(q, a));
+                hash[q] = h;
+                order[q] = q;
+            }
+        });
+
+        // Sort chunks in parallel, then merge pairs of runs in parallel
+        uint32_t chunk = (threads <= 1 || n < 4096) ? n : (n + threads - 1) / threads;
+        parallelFor(threads, n, [&](uint32_t begin, uint32_t end) {
+            std::sort(order.begin() + begin, order.begin() + end, less);
+        });
+        for (uint32_t width = chunk; width < n; width *= 2) {
+            uint32_t pairs = (n + 2 * width - 1) / (2 * width);
+            std::vector<std::thread> pool;
+            for (uint32_t p = 0; p < pairs; ++p) {
+                uint32_t lo = p * 2 * width;
+                uint32_t mid = std::min(n, lo + width);
+                uint32_t hi = std::min(n, lo + 2 * width);
+                pool.emplace_back([&, lo, mid, hi] {
+                    std::merge(order.begin() + lo, order.begin() + mid, order.begin() + mid, order.begin() + hi,
+                               scratch.begin() + lo, less);
+                });
+            }
+            for (auto& th : pool) th.join();
+            order.swap(scratch);
+        }
+
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < n; ++i) {
+            if (i > 0 && !same(order[i - 1], order[i])) ++count;
+            nextBlock[order[i]] = count;
+        }
+        ++count;
+
+        block.swap(nextBlock);
+        // A round can only split blocks, so an unchanged count means a fixed point
+        if (count == numBlocks) break;
+        numBlocks = count;
+    }
+
+    classOf = block;
+    return Quotient::canonicalize(classOf);
+}
+
+CompactDFA ParallelMoore::minimize(const CompactDFA& dfa, unsigned threads) {
+    CompactDFA reachable = dfa.reachablePart();
+    std::vector<uint32_t> classOf;
+    uint32_t numClasses = refine(reachable, classOf, threads);
+    return Quotient::build(reachable, classOf, numClasses);
+}
+
+DFA ParallelMoore::minimize(const DFA& dfa, unsigned threads) {
+    DFA minDFA = minimize(CompactDFA::fromDFA(dfa), threads).toDFA();
+    minDFA.alphabet = dfa.alphabet;
+    return minDFA;
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+#include "../model/DFA.h"
+#include "../model/CompactDFA.h"
+#include <vector>
+
+// Moore-style partition refinement spread over several threads.
+// Every round computes a signature per state (its block plus the block of each
+// successor) in parallel, sorts states by signature with a parallel merge sort
+// and renumbers blocks; rounds repeat until the block count stops growing.
+// O(n·|Σ|·log n) work per round, but every round scales with the core count,
+// unlike Hopcroft's sequential worklist. Same partition as Hopcroft::refine.
+class ParallelMoore {
+public:
+    // threads == 0 uses std::thread::hardware_concurrency()
+    static CompactDFA minimize(const CompactDFA& dfa, unsigned threads = 0);
+    static DFA minimize(const DFA& dfa, unsigned threads = 0);
+    static uint32_t refine(const CompactDFA& dfa, std::vector<uint32_t>& classOf, unsigned threads = 0);
+};
\ No newline at end of file
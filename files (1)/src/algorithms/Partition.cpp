@@ -0,0 +1,42 @@
+#include "Partition.h"
+
+void RefinablePartition::init(uint32_t n) {
+    m_elems.resize(n);
+    m_loc.resize(n);
+    m_blockOf.assign(n, 0);
+    for (uint32_t i = 0; i < n; ++i) m_elems[i] = m_loc[i] = i;
+
+    m_first.clear();
+    m_end.clear();
+    m_marked.clear();
+    m_touched.clear();
+    if (n > 0) {
+        m_first.push_back(0);
+        m_end.push_back(n);
+        m_marked.push_back(0);
+    }
+}
+
+void RefinablePartition::reserve(uint32_t n) {
+    m_elems.reserve(n);
+    m_loc.reserve(n);
+    m_blockOf.reserve(n);
+    m_first.reserve(n);
+    m_end.reserve(n);
+    m_marked.reserve(n);
+    m_touched.reserve(n);
+}
+
+void RefinablePartition::mark(uint32_t e) {
+    uint32_t b = m_blockOf[e];
+    uint32_t i = m_loc[e];
+    uint32_t j = m_first[b] + m_marked[b];
+    if (i < j) return; // already marked
+
+    // Swap e into the marked prefix of its block
+    m_elems[i] = m_elems[j];
+    m_loc[m_elems[i]] = i;
+    m_elems[j] = e;
+    m_loc[e] = j;
+    if (m_marked[b]++ == 0) m_touched.push_back(b);
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Refinable partition of {0, ..., n-1} after Valmari & Lehtinen.
+// The elements of a block are contiguous in one array; marking an element
+// swaps it to the front of its block, and split() cuts every block that has
+// marked elements in two. The smaller part always receives the new block id,
+// which is exactly the half Hopcroft's "process the smaller half" rule needs.
+class RefinablePartition {
+public:
+    // One block holding all n elements (no blocks when n == 0)
+    void init(uint32_t n);
+    // Room for n elements, so init(n) and every split after it allocate nothing
+    void reserve(uint32_t n);
+
+    uint32_t numBlocks() const { return uint32_t(m_first.size()); }
+    uint32_t blockOf(uint32_t e) const { return m_blockOf[e]; }
+    uint32_t size(uint32_t b) const { return m_end[b] - m_first[b]; }
+    const uint32_t* begin(uint32_t b) const { return m_elems.data() + m_first[b]; }
+    const uint32_t* end(uint32_t b) const { return m_elems.data() + m_end[b]; }
+    const std::vector<uint32_t>& blocks() const { return m_blockOf; }
+
+    // Marking an element twice before split() is harmless
+    void mark(uint32_t e);
+    bool hasMarks() const { return !m_touched.empty(); }
+
+    // Splits every block with marked elements and clears all marks.
+    // onSplit(oldBlock, newBlock) is called for each block that actually split.
+    template <class F>
+    void split(F&& onSplit) {
+        while (!m_touched.empty()) {
+            uint32_t b = m_touched.back();
+            m_touched.pop_back();
+            uint32_t mid = m_first[b] + m_marked[b];
+            m_marked[b] = 0;
+            if (mid == m_end[b]) continue; // whole block marked, nothing to split
+
+            uint32_t z = numBlocks();
+            if (mid - m_first[b] <= m_end[b] - mid) {
+                m_first.push_back(m_first[b]);
+                m_end.push_back(mid);
+                m_first[b] = mid;
+            } else {
+                m_first.push_back(mid);
+                m_end.push_back(m_end[b]);
+                m_end[b] = mid;
+            }
+            m_marked.push_back(0);
+            for (uint32_t i = m_first[z]; i < m_end[z]; ++i) m_blockOf[m_elems[i]] = z;
+            onSplit(b, z);
+        }
+    }
+    void split() { split([](uint32_t, uint32_t) {}); }
+
+private:
+    std::vector<uint32_t> m_elems;   // elements grouped by block
+    std::vector<uint32_t> m_loc;     // position of each element in m_elems
+    std::vector<uint32_t> m_blockOf; // block of each element
+    std::vector<uint32_t> m_first;   // block start in m_elems
+    std::vector<uint32_t> m_end;     // block end (exclusive)
+    std::vector<uint32_t> m_marked;  // marked prefix length per block
+    std::vector<uint32_t> m_touched; // blocks with at least one mark
+};
\ No newline at end of file
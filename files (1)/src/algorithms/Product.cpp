@@ -0,0 +1,131 @@
+#include "Product.h"
+#include "Valmari.h"
+#include <unordered_map>
+
+namespace {
+
+constexpr uint32_t NONE = CompactDFA::NONE;
+
+// NONE is the dead side: it rejects and never leaves
+uint32_t step(const CompactDFA& dfa, uint32_t q, uint32_t column) {
+    return q == NONE || column == NONE ? NONE : dfa.next(q, column);
+}
+
+bool accepting(const CompactDFA& dfa, uint32_t q) { return q != NONE && dfa.isAccept(q); }
+
+bool combine(ProductOp op, bool inA, bool inB) {
+    switch (op) {
+    case ProductOp::Union: return inA || inB;
+    case ProductOp::SymmetricDifference: return inA != inB;
+    case ProductOp::Difference: return inA && !inB;
+    case ProductOp::Intersection:
+    default: return inA && inB;
+    }
+}
+
+// False once no word can lead the pair to an accepting combination
+bool alive(ProductOp op, uint32_t p, uint32_t q) {
+    switch (op) {
+    case ProductOp::Union:
+    case ProductOp::SymmetricDifference: return p != NONE || q != NONE;
+    case ProductOp::Difference: return p != NONE;
+    case ProductOp::Intersection:
+    default: return p != NONE && q != NONE;
+    }
+}
+
+} // namespace
+
+CompactDFA Product::build(const CompactDFA& a, const CompactDFA& b, ProductOp op, bool minimize) {
+    CompactDFA out;
+
+    // Merged alphabet: column x is column inA[x] of a and inB[x] of b
+    std::vector<uint32_t> inA, inB;
+    for (uint32_t x = 0; x < a.numSymbols(); ++x) out.addSymbol(a.symbol(x));
+    for (uint32_t x = 0; x < b.numSymbols(); ++x) out.addSymbol(b.symbol(x));
+    for (uint32_t x = 0; x < out.numSymbols(); ++x) {
+        inA.push_back(a.symbolIndex(out.symbol(x)));
+        inB.push_back(b.symbolIndex(out.symbol(x)));
+    }
+
+    // The state list doubles as the breadth-first queue: pair i is expanded
+    // after every pair created before it
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    std::unordered_map<uint64_t, uint32_t> ids;
+    pairs.reserve(size_t(a.numStates()) + b.numStates());
+    ids.reserve(size_t(a.numStates()) + b.numStates());
+    auto id = [&](uint32_t p, uint32_t q) {
+        auto it = ids.emplace((uint64_t(p) << 32) | q, uint32_t(pairs.size()));
+        if (it.second) {
+            pairs.emplace_back(p, q);
+            // A taken name gets the index; suffixed names end in a digit, so
+            // they never meet an unsuffixed one
+            std::string name = "(" + (p == NONE ? std::string("_") : a.stateId(p)) + "," +
+                               (q == NONE ? std::string("_") : b.stateId(q)) + ")";
+            if (out.stateIndex(name) != NONE) name += "#" + std::to_string(pairs.size() - 1);
+            out.addState(name, pairs.size() == 1, combine(op, accepting(a, p), accepting(b, q)));
+        }
+        return it.first->second;
+    };
+
+    // The start pair exists even when it is dead, so an empty language
+    // still comes out as one rejecting start state
+    uint32_t p0 = a.startState(), q0 = b.startState();
+    id(p0, q0);
+    if (!alive(op, p0, q0)) return out;
+    for (uint32_t i = 0; i < pairs.size(); ++i) {
+        const auto [p, q] = pairs[i];
+        for (uint32_t x = 0; x < out.numSymbols(); ++x) {
+            uint32_t p2 = step(a, p, inA[x]), q2 = step(b, q, inB[x]);
+            if (alive(op, p2, q2)) out.setTransition(i, x, id(p2, q2));
+        }
+    }
+    return minimize ? Valmari::minimize(out) : out;
+}
+
+DFA Product::build(const DFA& a, const DFA& b, ProductOp op, bool minimize) {
+    return build(CompactDFA::fromDFA(a), CompactDFA::fromDFA(b), op, minimize).toDFA();
+}
+
+CompactDFA Product::complement(const CompactDFA& dfa) {
+    CompactDFA out = dfa;
+    uint32_t sink = NONE;
+    for (uint32_t q = 0; q < dfa.numStates(); ++q) {
+        out.setAccept(q, !dfa.isAccept(q));
+        for (uint32_t x = 0; x < dfa.numSymbols(); ++x) {
+            if (dfa.next(q, x) != NONE) continue;
+            if (sink == NONE) {
+                std::string name = "sink";
+                for (int i = 1; dfa.stateIndex(name) != NONE; ++i) name = "sink" + std::to_string(i);
+                sink = out.addState(name, false, true);
+                for (uint32_t y = 0; y < dfa.numSymbols(); ++y) out.setTransition(sink, y, sink);
+            }
+            out.setTransition(q, x, sink);
+        }
+    }
+    return out;
+}
+
+DFA Product::complement(const DFA& dfa) {
+    return complement(CompactDFA::fromDFA(dfa)).toDFA();
+}
+
+const char* Product::name(ProductOp op) {
+    switch (op) {
+    case ProductOp::Union: return "union";
+    case ProductOp::SymmetricDifference: return "xor";
+    case ProductOp::Difference: return "difference";
+    case ProductOp::Intersection:
+    default: return "intersection";
+    }
+}
+
+bool Product::parse(const std::string& name, ProductOp& op) {
+    for (auto o : {ProductOp::Intersection, ProductOp::Union, ProductOp::SymmetricDifference, ProductOp::Difference}) {
+        if (name == Product::name(o)) {
+            op = o;
+            return true;
+        }
+    }
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+#include "../model/DFA.h"
+#include "../model/CompactDFA.h"
+
+enum class ProductOp {
+    Intersection,        // L(a) ∩ L(b)
+    Union,               // L(a) ∪ L(b)
+    SymmetricDifference, // words in exactly one of them
+    Difference           // L(a) \ L(b)
+};
+
+// Boolean combinations of two automata, built on the fly: only the pairs
+// reachable from the start pair are ever created, so combining two 100k-state
+// automata costs the reachable product, not |Qa|·|Qb|. Missing transitions
+// reject; the alphabet is a's symbols followed by b's other ones.
+class Product {
+public:
+    // States are named "(p,q)" with "_" for a side that has no transition
+    // left, plus a "#index" suffix when ids with commas make that name
+    // ambiguous. Pairs that can no longer accept under op (both sides gone for a
+    // union, either side for an intersection) are not created; the
+    // transition stays missing instead. With minimize the result goes
+    // straight through Valmari, which takes partial automata as they are.
+    static CompactDFA build(const CompactDFA& a, const CompactDFA& b, ProductOp op, bool minimize = false);
+    static DFA build(const DFA& a, const DFA& b, ProductOp op, bool minimize = false);
+
+    // Σ* \ L(dfa) over dfa's own alphabet: missing transitions go to a new
+    // sink and every state flips. Unreachable states are kept.
+    static CompactDFA complement(const CompactDFA& dfa);
+    static DFA complement(const DFA& dfa);
+
+    static const char* name(ProductOp op);
+    // Accepts the names returned by name(); returns false for anything else
+    static bool parse(const std::string& name, ProductOp& op);
+};
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include "Quotient.h"
+
+uint32_t Quotient::canonicalize(std::vector<uint32_t>& classOf) {
+    std::vector<uint32_t> renumber;
+    uint32_t count = 0;
+    for (auto& c : classOf) {
+        if (c >= renumber.size()) renumber.resize(size_t(c) + 1, CompactDFA::NONE);
+        if (renumber[c] == CompactDFA::NONE) renumber[c] = count++;
+        c = renumber[c];
+    }
+    return count;
+}
+
+CompactDFA Quotient::build(const CompactDFA& dfa, const std::vector<uint32_t>& classOf, uint32_t numClasses) {
+    CompactDFA q;
+    q.reserve(numClasses, dfa.numSymbols());
+    for (const auto& sym : dfa.symbols()) q.addSymbol(sym);
+
+    for (uint32_t b = 0; b < numClasses; ++b) q.addState("Q" + std::to_string(b), false, false);
+
+    std::vector<bool> done(numClasses, false);
+    for (uint32_t s = 0; s < dfa.numStates(); ++s) {
+        uint32_t b = classOf[s];
+        if (b == CompactDFA::NONE) continue;
+        if (dfa.isStart(s)) q.setStart(b, true);
+        if (dfa.isAccept(s)) q.setAccept(b, true);
+        if (done[b]) continue;
+        done[b] = true;
+        // Each class sits where its first member was; see Layout for the rest
+        q.setPosition(b, dfa.x(s), dfa.y(s));
+
+        const uint32_t* r = dfa.row(s);
+        for (uint32_t a = 0; a < dfa.numSymbols(); ++a) {
+            if (r[a] != CompactDFA::NONE) q.setTransition(b, a, classOf[r[a]]);
+        }
+    }
+    return q;
+}
\ No newline at end of file
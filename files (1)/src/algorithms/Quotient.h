@@ -0,0 +1,17 @@
+#pragma once
+#include "../model/CompactDFA.h"
+#include <vector>
+
+// Shared tail of every minimizer: turns a state -> class map into the
+// minimized automaton.
+class Quotient {
+public:
+    // Renumbers classes in order of their first state, so every minimizer
+    // names the same class the same way. Returns the number of classes.
+    static uint32_t canonicalize(std::vector<uint32_t>& classOf);
+
+    // One state per class, named Q0, Q1, ..., placed at its first member.
+    // Transitions are taken from any member; the partition must be stable.
+    // States in class NONE are left out; no kept state may lead to one.
+    static CompactDFA build(const CompactDFA& dfa, const std::vector<uint32_t>& classOf, uint32_t numClasses);
+};
\ No newline at end of file
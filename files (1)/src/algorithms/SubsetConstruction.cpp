@@ -0,0 +1,234 @@
+#include "SubsetConstruction.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint32_t NONE = CompactDFA::NONE;
+
+// Per-state lists in compressed-row form: items[offsets[q] .. offsets[q + 1])
+struct Rows {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> items;
+
+    const uint32_t* begin(uint32_t q) const { return items.data() + offsets[q]; }
+    const uint32_t* end(uint32_t q) const { return items.data() + offsets[q + 1]; }
+};
+
+// ε-closure of every state, each sorted, by one depth-first search per state
+Rows closures(const NFA& nfa, const Rows& epsilon) {
+    const uint32_t n = nfa.numStates();
+    Rows out;
+    out.offsets.reserve(size_t(n) + 1);
+    out.offsets.push_back(0);
+    std::vector<uint32_t> stamp(n, NONE), stack;
+    for (uint32_t q = 0; q < n; ++q) {
+        size_t first = out.items.size();
+        stamp[q] = q;
+        stack.push_back(q);
+        while (!stack.empty()) {
+            uint32_t p = stack.back();
+            stack.pop_back();
+            out.items.push_back(p);
+            for (const uint32_t* t = epsilon.begin(p); t != epsilon.end(p); ++t) {
+                if (stamp[*t] != q) {
+                    stamp[*t] = q;
+                    stack.push_back(*t);
+                }
+            }
+        }
+        std::sort(out.items.begin() + first, out.items.end());
+        out.offsets.push_back(uint32_t(out.items.size()));
+    }
+    return out;
+}
+
+// Sorted NFA state sets stored back to back in one pool and interned by an
+// open-addressing table of subset indices
+class SubsetTable {
+public:
+    SubsetTable() : m_slots(1024, NONE) { m_offsets.push_back(0); }
+
+    uint32_t size() const { return uint32_t(m_offsets.size() - 1); }
+    const uint32_t* begin(uint32_t s) const { return m_pool.data() + m_offsets[s]; }
+    const uint32_t* end(uint32_t s) const { return m_pool.data() + m_offsets[s + 1]; }
+
+    // Index of the set, or NONE; slot receives where it would go
+    uint32_t find(const std::vector<uint32_t>& set, uint64_t hash, size_t& slot) const {
+        const size_t mask = m_slots.size() - 1;
+        for (slot = hash & mask; m_slots[slot] != NONE; slot = (slot + 1) & mask) {
+            uint32_t s = m_slots[slot];
+            if (m_hashes[s] == hash && std::equal(set.begin(), set.end(), begin(s), end(s))) return s;
+        }
+        return NONE;
+    }
+
+    uint32_t insert(const std::vector<uint32_t>& set, uint64_t hash, size_t slot) {
+        uint32_t s = size();
+        m_pool.insert(m_pool.end(), set.begin(), set.end());
+        m_offsets.push_back(uint32_t(m_pool.size()));
+        m_hashes.push_back(hash);
+        m_slots[slot] = s;
+        if (2 * size_t(size()) > m_slots.size()) grow();
+        return s;
+    }
+
+    static uint64_t hash(const std::vector<uint32_t>& set) {
+        uint64_t h = 0x9E3779B97F4A7C15ull ^ set.size();
+        for (uint32_t q : set) h = (h ^ q) * 0xFF51AFD7ED558CCDull;
+        return h ^ (h >> 32);
+    }
+
+private:
+    void grow() {
+        m_slots.assign(m_slots.size() * 2, NONE);
+        const size_t mask = m_slots.size() - 1;
+        for (uint32_t s = 0; s < size(); ++s) {
+            size_t slot = m_hashes[s] & mask;
+            while (m_slots[slot] != NONE) slot = (slot + 1) & mask;
+            m_slots[slot] = s;
+        }
+    }
+
+    std::vector<uint32_t> m_pool;
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint64_t> m_hashes;
+    std::vector<uint32_t> m_slots; // power of two, at most half full
+};
+
+std::string subsetName(const NFA& nfa, const uint32_t* first, const uint32_t* last, uint32_t index) {
+    const size_t shown = 8;
+    std::string name = "{";
+    for (const uint32_t* q = first; q != last && size_t(q - first) < shown; ++q) {
+        name += (q == first ? "" : ",") + nfa.stateId(*q);
+    }
+    if (size_t(last - first) <= shown) return name + "}";
+    return name + ",…}#" + std::to_string(index);
+}
+
+} // namespace
+
+bool SubsetConstruction::determinize(const NFA& nfa, CompactDFA& out, uint32_t maxStates) {
+    const uint32_t n = nfa.numStates();
+    const uint32_t k = nfa.numSymbols();
+    out.clear();
+    for (uint32_t a = 0; a < k; ++a) out.addSymbol(nfa.symbol(a));
+
+    // Edges by source state: ε-targets in one list, (symbol, target) pairs
+    // sorted by symbol in the other
+    Rows epsilon;
+    std::vector<uint32_t> moveOffsets(size_t(n) + 1, 0);
+    epsilon.offsets.assign(size_t(n) + 1, 0);
+    for (const auto& e : nfa.edges()) ++(e.symbol == NFA::Epsilon ? epsilon.offsets : moveOffsets)[e.from + 1];
+    for (uint32_t q = 0; q < n; ++q) {
+        epsilon.offsets[q + 1] += epsilon.offsets[q];
+        moveOffsets[q + 1] += moveOffsets[q];
+    }
+    epsilon.items.resize(epsilon.offsets[n]);
+    std::vector<std::pair<uint32_t, uint32_t>> moves(moveOffsets[n]);
+    {
+        std::vector<uint32_t> epsFill(epsilon.offsets.begin(), epsilon.offsets.end() - 1);
+        std::vector<uint32_t> moveFill(moveOffsets.begin(), moveOffsets.end() - 1);
+        for (const auto& e : nfa.edges()) {
+            if (e.symbol == NFA::Epsilon) epsilon.items[epsFill[e.from]++] = e.to;
+            else moves[moveFill[e.from]++] = {e.symbol, e.to};
+        }
+    }
+    for (uint32_t q = 0; q < n; ++q) std::sort(moves.begin() + moveOffsets[q], moves.begin() + moveOffsets[q + 1]);
+    const Rows closure = closures(nfa, epsilon);
+
+    SubsetTable subsets;
+    std::vector<uint32_t> set;
+    std::vector<uint32_t> stamp(n, NONE);
+    uint32_t stampValue = 0;
+    bool complete = true;
+    // Index of the DFA state for set (sorted), adding it if new; NONE past the limit
+    auto intern = [&]() {
+        uint64_t h = SubsetTable::hash(set);
+        size_t slot;
+        uint32_t s = subsets.find(set, h, slot);
+        if (s != NONE) return s;
+        if (maxStates && subsets.size() >= maxStates) {
+            complete = false;
+            return NONE;
+        }
+        s = subsets.insert(set, h, slot);
+        bool accept = false;
+        for (uint32_t q : set) accept = accept || nfa.isAccept(q);
+        std::string name = subsetName(nfa, set.data(), set.data() + set.size(), s);
+        if (out.stateIndex(name) != NONE) name += "#" + std::to_string(s); // ids with commas
+        out.addState(name, s == 0, accept);
+        return s;
+    };
+    // Adds the closure of q to set, once per member
+    auto addClosure = [&](uint32_t q) {
+        for (const uint32_t* p = closure.begin(q); p != closure.end(q); ++p) {
+            if (stamp[*p] != stampValue) {
+                stamp[*p] = stampValue;
+                set.push_back(*p);
+            }
+        }
+    };
+
+    // The start closure is state 0 even when empty, so an NFA without start
+    // states still gives one rejecting start state
+    for (uint32_t q = 0; q < n; ++q) {
+        if (nfa.isStart(q)) addClosure(q);
+    }
+    std::sort(set.begin(), set.end());
+    intern();
+
+    std::vector<std::pair<uint32_t, uint32_t>> step;
+    for (uint32_t s = 0; s < subsets.size() && complete; ++s) {
+        // Every move out of the subset, grouped by symbol
+        step.clear();
+        for (const uint32_t* q = subsets.begin(s); q != subsets.end(s); ++q) {
+            step.insert(step.end(), moves.begin() + moveOffsets[*q], moves.begin() + moveOffsets[*q + 1]);
+        }
+        std::sort(step.begin(), step.end());
+        for (size_t i = 0; i < step.size();) {
+            uint32_t a = step[i].first;
+            set.clear();
+            if (++stampValue == NONE) {
+                std::fill(stamp.begin(), stamp.end(), NONE);
+                stampValue = 0;
+            }
+            for (; i < step.size() && step[i].first == a; ++i) addClosure(step[i].second);
+            std::sort(set.begin(), set.end());
+            uint32_t target = intern();
+            if (target != NONE) out.setTransition(s, a, target);
+        }
+    }
+    return complete;
+}
+
+CompactDFA SubsetConstruction::determinize(const NFA& nfa) {
+    CompactDFA out;
+    determinize(nfa, out);
+    return out;
+}
+
+bool SubsetConstruction::needed(const DFA& dfa) {
+    if (!dfa.isDeterministic()) return true;
+    for (const auto& kv : dfa.transitions) {
+        if (NFA::isEpsilon(kv.first.second)) return true;
+    }
+    return false;
+}
+
+bool SubsetConstruction::needed(const NFA& nfa) {
+    if (nfa.hasEpsilon()) return true;
+    uint32_t starts = 0;
+    for (uint32_t q = 0; q < nfa.numStates(); ++q) starts += nfa.isStart(q);
+    if (starts > 1) return true;
+    std::unordered_map<uint64_t, uint32_t> target; // (from, symbol) -> to
+    for (const auto& e : nfa.edges()) {
+        auto it = target.emplace((uint64_t(e.from) << 32) | e.symbol, e.to).first;
+        if (it->second != e.to) return true;
+    }
+    return false;
+}
+
+DFA SubsetConstruction::determinize(const DFA& dfa) {
+    return determinize(NFA::fromDFA(dfa)).toDFA();
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+#include "../model/DFA.h"
+#include "../model/CompactDFA.h"
+#include "../model/NFA.h"
+
+// Subset construction for NFAs with ε-transitions. The ε-closure of every
+// NFA state is computed once up front; a DFA state is then the sorted array
+// of NFA states it stands for, interned in an open-addressing hash table over
+// one shared pool, and each new one is appended straight to the compact
+// transition table. Only subsets reachable from the start closure are built.
+// The empty subset is left out, so missing transitions reject; the result
+// is ready for any minimizer (Valmari takes it as it is).
+class SubsetConstruction {
+public:
+    // States are named "{p,q,…}" after their members; subsets of more than
+    // eight states are shortened and get a "#index" suffix to stay unique, as
+    // does a name that member ids with commas make ambiguous.
+    // Returns false, with out holding the states built so far, once more
+    // than maxStates would be needed (0 = no limit).
+    static bool determinize(const NFA& nfa, CompactDFA& out, uint32_t maxStates = 0);
+    static CompactDFA determinize(const NFA& nfa);
+
+    // True when dfa has displaced transitions (DFA::conflicts) or ε-transitions
+    static bool needed(const DFA& dfa);
+    // Same for nfa, which also needs it with more than one start state
+    static bool needed(const NFA& nfa);
+    // NFA::fromDFA, determinize, and back; ε drops out of the alphabet
+    static DFA determinize(const DFA& dfa);
+};
\ No newline at end of file
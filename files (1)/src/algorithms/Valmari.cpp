@@ -0,0 +1,84 @@
+#include "Valmari.h"
+#include "Partition.h"
+#include "Quotient.h"
+
+CompactDFA Valmari::minimize(const CompactDFA& dfa) {
+    // Start state plus every state on an accepting path; missing transitions reject anyway
+    CompactDFA trimmed = dfa.trimmed();
+    const uint32_t n = trimmed.numStates();
+    const uint32_t k = trimmed.numSymbols();
+
+    // Flat transition list, grouped by label: tail, label, head
+    std::vector<uint32_t> labelStart(k + 1, 0);
+    for (uint32_t q = 0; q < n; ++q) {
+        const uint32_t* r = trimmed.row(q);
+        for (uint32_t a = 0; a < k; ++a) {
+            if (r[a] != CompactDFA::NONE) ++labelStart[a + 1];
+        }
+    }
+    for (uint32_t a = 0; a < k; ++a) labelStart[a + 1] += labelStart[a];
+    const uint32_t m = labelStart[k];
+    std::vector<uint32_t> tail(m), head(m);
+    std::vector<uint32_t> fill(labelStart.begin(), labelStart.end() - 1);
+    for (uint32_t q = 0; q < n; ++q) {
+        const uint32_t* r = trimmed.row(q);
+        for (uint32_t a = 0; a < k; ++a) {
+            if (r[a] == CompactDFA::NONE) continue;
+            uint32_t t = fill[a]++;
+            tail[t] = q;
+            head[t] = r[a];
+        }
+    }
+
+    // Incoming transitions of each state
+    std::vector<uint32_t> inStart(n + 1, 0);
+    for (uint32_t t = 0; t < m; ++t) ++inStart[head[t] + 1];
+    for (uint32_t q = 0; q < n; ++q) inStart[q + 1] += inStart[q];
+    std::vector<uint32_t> in(m);
+    std::vector<uint32_t> inFill(inStart.begin(), inStart.end() - 1);
+    for (uint32_t t = 0; t < m; ++t) in[inFill[head[t]]++] = t;
+
+    // Blocks: {F, Q\F}
+    RefinablePartition B;
+    B.init(n);
+    for (uint32_t q = 0; q < n; ++q) {
+        if (trimmed.isAccept(q)) B.mark(q);
+    }
+    B.split();
+
+    // Cords: one per label
+    RefinablePartition C;
+    C.init(m);
+    for (uint32_t a = 0; a + 1 < k; ++a) {
+        for (uint32_t t = labelStart[a]; t < labelStart[a + 1]; ++t) C.mark(t);
+        C.split();
+    }
+
+    // Every transition has a head, so splitting cords by one half of a block
+    // also splits them by the other half: block 0 and the larger half of every
+    // later split never need processing.
+    uint32_t b = 1;
+    uint32_t c = 0;
+    while (c < C.numBlocks()) {
+        for (const uint32_t* t = C.begin(c); t != C.end(c); ++t) B.mark(tail[*t]);
+        B.split();
+        ++c;
+        while (b < B.numBlocks()) {
+            for (const uint32_t* q = B.begin(b); q != B.end(b); ++q) {
+                for (uint32_t i = inStart[*q]; i < inStart[*q + 1]; ++i) C.mark(in[i]);
+            }
+            C.split();
+            ++b;
+        }
+    }
+
+    std::vector<uint32_t> classOf = B.blocks();
+    uint32_t numClasses = Quotient::canonicalize(classOf);
+    return Quotient::build(trimmed, classOf, numClasses);
+}
+
+DFA Valmari::minimize(const DFA& dfa) {
+    DFA minDFA = minimize(CompactDFA::fromDFA(dfa)).toDFA();
+    minDFA.alphabet = dfa.alphabet;
+    return minDFA;
+}
\ No newline at end of file
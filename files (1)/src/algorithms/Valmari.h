@@ -0,0 +1,16 @@
+#pragma once
+#include "../model/DFA.h"
+#include "../model/CompactDFA.h"
+#include <vector>
+
+// Valmari–Lehtinen minimization of partial DFAs in O(m log n), m = number of
+// transitions. States and transitions are both kept in refinable partitions
+// ("blocks" and "cords"), so missing transitions never have to be completed
+// with a sink. States that cannot reach an accepting state are dropped: the
+// result is the minimal partial DFA, i.e. the minimal complete DFA for the
+// same language without its sink.
+class Valmari {
+public:
+    static CompactDFA minimize(const CompactDFA& dfa);
+    static DFA minimize(const DFA& dfa);
+};
\ No newline at end of file
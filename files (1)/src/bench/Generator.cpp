@@ -0,0 +1,133 @@
+#include "Generator.h"
+#include <utility>
+#include <vector>
+
+namespace {
+
+// SplitMix64: tiny, fast and identical on every standard library
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : m_state(seed) {}
+    uint64_t next() {
+        uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    uint32_t below(uint32_t n) { return uint32_t(((next() >> 32) * n) >> 32); }
+    bool chance(double p) { return double(next() >> 11) * 0x1.0p-53 < p; }
+
+private:
+    uint64_t m_state;
+};
+
+// Binary de Bruijn word of order m (length 2^m), FKM algorithm
+void deBruijn(uint32_t t, uint32_t p, uint32_t m, std::vector<uint8_t>& a, std::vector<uint8_t>& out) {
+    if (t > m) {
+        if (m % p == 0) out.insert(out.end(), a.begin() + 1, a.begin() + 1 + p);
+        return;
+    }
+    a[t] = a[t - p];
+    deBruijn(t + 1, p, m, a, out);
+    for (uint8_t j = a[t - p] + 1; j < 2; ++j) {
+        a[t] = j;
+        deBruijn(t + 1, t, m, a, out);
+    }
+}
+
+} // namespace
+
+CompactDFA Generator::generate(const GeneratorOptions& options) {
+    const uint32_t n = options.states;
+    const uint32_t k = options.family == GeneratorFamily::UnaryCycle ? 1 : options.symbols;
+    Rng rng(options.seed);
+
+    CompactDFA dfa;
+    dfa.reserve(n, k);
+    for (uint32_t a = 0; a < k; ++a) dfa.addSymbol(std::to_string(a));
+    for (uint32_t q = 0; q < n; ++q) dfa.addState("q" + std::to_string(q), q == 0, false);
+    if (n == 0) return dfa;
+
+    switch (options.family) {
+    case GeneratorFamily::RandomComplete:
+        for (uint32_t q = 0; q < n; ++q) {
+            dfa.setAccept(q, rng.chance(0.5));
+            for (uint32_t a = 0; a < k; ++a) dfa.setTransition(q, a, rng.below(n));
+        }
+        break;
+    case GeneratorFamily::RandomPartial: {
+        // Random spanning tree first, so the reachable part is the whole
+        // automaton: every new state takes a free slot of an earlier one
+        std::vector<std::pair<uint32_t, uint32_t>> open;
+        for (uint32_t a = 0; a < k; ++a) open.emplace_back(0, a);
+        for (uint32_t q = 1; q < n && !open.empty(); ++q) {
+            uint32_t i = rng.below(uint32_t(open.size()));
+            dfa.setTransition(open[i].first, open[i].second, q);
+            open[i] = open.back();
+            open.pop_back();
+            for (uint32_t a = 0; a < k; ++a) open.emplace_back(q, a);
+        }
+        for (const auto& slot : open) {
+            if (rng.chance(options.density)) dfa.setTransition(slot.first, slot.second, rng.below(n));
+        }
+        for (uint32_t q = 0; q < n; ++q) dfa.setAccept(q, rng.chance(0.5));
+        break;
+    }
+    case GeneratorFamily::DeBruijn:
+        for (uint32_t q = 0; q < n; ++q) {
+            dfa.setAccept(q, rng.chance(0.5));
+            for (uint32_t a = 0; a < k; ++a) dfa.setTransition(q, a, uint32_t((uint64_t(q) * k + a) % n));
+        }
+        break;
+    case GeneratorFamily::UnaryCycle: {
+        // Exactly the Berstel–Carton worst case when n is a power of two;
+        // otherwise the word is truncated to n letters.
+        uint32_t m = 1;
+        while (m < 32 && (uint64_t(1) << m) < n) ++m;
+        std::vector<uint8_t> a(m + 1, 0), word;
+        word.reserve(size_t(1) << m);
+        deBruijn(1, 1, m, a, word);
+        for (uint32_t q = 0; q < n; ++q) {
+            dfa.setAccept(q, word[q] != 0);
+            dfa.setTransition(q, 0, q + 1 < n ? q + 1 : 0);
+        }
+        break;
+    }
+    case GeneratorFamily::Minimal: {
+        // Chain order[0] -> ... -> order[n-1] on symbol 0 with only the last
+        // state accepting: state order[i] is the only one that accepts 0^(n-1-i)
+        std::vector<uint32_t> order(n);
+        for (uint32_t q = 0; q < n; ++q) order[q] = q;
+        for (uint32_t i = n - 1; i > 1; --i) std::swap(order[i], order[1 + rng.below(i)]);
+        for (uint32_t i = 0; i < n; ++i) {
+            dfa.setTransition(order[i], 0, order[i + 1 < n ? i + 1 : i]);
+            for (uint32_t a = 1; a < k; ++a) dfa.setTransition(order[i], a, rng.below(n));
+        }
+        dfa.setAccept(order[n - 1], true);
+        break;
+    }
+    }
+    return dfa;
+}
+
+const char* Generator::name(GeneratorFamily family) {
+    switch (family) {
+    case GeneratorFamily::RandomPartial: return "partial";
+    case GeneratorFamily::DeBruijn: return "debruijn";
+    case GeneratorFamily::UnaryCycle: return "cycle";
+    case GeneratorFamily::Minimal: return "minimal";
+    case GeneratorFamily::RandomComplete:
+    default: return "complete";
+    }
+}
+
+bool Generator::parse(const std::string& name, GeneratorFamily& family) {
+    for (auto f : {GeneratorFamily::RandomComplete, GeneratorFamily::RandomPartial, GeneratorFamily::DeBruijn,
+                   GeneratorFamily::UnaryCycle, GeneratorFamily::Minimal}) {
+        if (name == Generator::name(f)) {
+            family = f;
+            return true;
+        }
+    }
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+#include "../model/CompactDFA.h"
+#include <cstdint>
+#include <string>
+
+enum class GeneratorFamily {
+    RandomComplete, // uniform targets, every transition defined
+    RandomPartial,  // random spanning tree from the start, other transitions with probability `density`
+    DeBruijn,       // q --a--> (q·k + a) mod n, random accepting set; Moore needs ~log_k n rounds
+    UnaryCycle,     // one-letter cycle labelled by a binary de Bruijn word: Hopcroft's Θ(n log n) case
+    Minimal         // already minimal: a shuffled chain on symbol 0 keeps every state distinct
+};
+
+struct GeneratorOptions {
+    GeneratorFamily family = GeneratorFamily::RandomComplete;
+    uint32_t states = 1000;
+    uint32_t symbols = 2;    // ignored by UnaryCycle
+    double density = 0.7;    // RandomPartial only
+    uint64_t seed = 1;
+};
+
+// Seeded synthetic automata for benchmarking. The same options give the same
+// automaton on every platform (the generator does not use <random>'s
+// implementation-defined distributions). States are named q0..q{n-1}, symbols
+// 0..k-1, and state 0 is the start state.
+class Generator {
+public:
+    static CompactDFA generate(const GeneratorOptions& options);
+
+    static const char* name(GeneratorFamily family);
+    static bool parse(const std::string& name, GeneratorFamily& family);
+};
\ No newline at end of file
@@ -0,0 +1,452 @@
+// dfa-bench: times the minimizers and the I/O paths on synthetic automata.
+// Writes one JSON object per line (phase) so runs can be diffed between commits:
+//   dfa-bench -n 10,1000,100000 -l "$(git rev-parse --short HEAD)" > bench.ndjson
+#include "Generator.h"
+#include "model/CompactDFA.h"
+#include "algorithms/AlphabetClasses.h"
+#include "algorithms/Equivalence.h"
+#include "algorithms/Hopcroft.h"
+#include "algorithms/Minimizer.h"
+#include "algorithms/Product.h"
+#include "io/DFABinary.h"
+#include "io/DFAJsonStream.h"
+#include "match/CompiledDFA.h"
+#include "layout/Layout.h"
+#include <QBuffer>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+// Every allocation in the process goes through these, so each phase can
+// report how many it made
+namespace {
+std::atomic<uint64_t> g_allocs{0};
+std::atomic<uint64_t> g_allocBytes{0};
+
+void* countedAlloc(std::size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (void* p = countedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+    if (void* p = countedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+// Linux can reset the high-water mark, so each phase gets its own peak;
+// elsewhere the value is the process peak so far. -1 when unknown.
+void resetPeakRss() {
+#if defined(__linux__)
+    std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+long peakRssKb() {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::strtol(line.c_str() + 6, nullptr, 10);
+    }
+    return -1;
+#elif defined(__APPLE__)
+    rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? long(usage.ru_maxrss / 1024) : -1;
+#elif defined(__unix__)
+    rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? long(usage.ru_maxrss) : -1;
+#else
+    return -1;
+#endif
+}
+
+struct Config {
+    std::vector<GeneratorFamily> families;
+    std::vector<uint32_t> sizes{10, 1000, 100000};
+    std::vector<MinimizerAlgorithm> algorithms;
+    uint32_t symbols = 2;
+    uint64_t seed = 1;
+    unsigned threads = 0;
+    uint32_t legacyMax = 1000;  // the map-based DFA code is quadratic; skip it above this
+    uint32_t ioMax = 1000000;   // the JSON phases keep the whole document in memory
+    uint32_t matchBytes = 1 << 24;
+    uint32_t layoutMax = 100000; // the GUI's layout engines; sized for interactive use
+    std::string label;
+};
+
+std::string quoted(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) out += c;
+    }
+    return out + "\"";
+}
+
+class Recorder {
+public:
+    Recorder(std::ostream& out, const Config& config) : m_out(out), m_config(config) {}
+
+    void setCase(GeneratorFamily family, uint32_t states) {
+        m_family = family;
+        m_states = states;
+    }
+
+    // Runs one phase and writes its record; `work` returns the size of its
+    // result (states, or bytes for the writers and the matcher)
+    void phase(const std::string& name, const std::function<uint64_t()>& work) {
+        resetPeakRss();
+        uint64_t allocs = g_allocs.load();
+        uint64_t bytes = g_allocBytes.load();
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t result = work();
+        auto t1 = std::chrono::steady_clock::now();
+        // Counted before the record itself allocates
+        allocs = g_allocs.load() - allocs;
+        bytes = g_allocBytes.load() - bytes;
+        double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+        std::ostringstream line;
+        line << "{\"label\":" << quoted(m_config.label)
+             << ",\"family\":" << quoted(Generator::name(m_family))
+             << ",\"states\":" << m_states
+             << ",\"symbols\":" << (m_family == GeneratorFamily::UnaryCycle ? 1 : m_config.symbols)
+             << ",\"seed\":" << m_config.seed
+             << ",\"phase\":" << quoted(name)
+             << ",\"ms\":" << ms
+             << ",\"peakRssKb\":" << peakRssKb()
+             << ",\"allocs\":" << allocs
+             << ",\"allocBytes\":" << bytes
+             << ",\"result\":" << result << "}\n";
+        m_out << line.str() << std::flush;
+    }
+
+private:
+    std::ostream& m_out;
+    const Config& m_config;
+    GeneratorFamily m_family = GeneratorFamily::RandomComplete;
+    uint32_t m_states = 0;
+};
+
+// Returns false when an "already minimal" input did not come out unchanged
+bool runCase(Recorder& rec, const Config& config, GeneratorFamily family, uint32_t n) {
+    rec.setCase(family, n);
+    GeneratorOptions gen;
+    gen.family = family;
+    gen.states = n;
+    gen.symbols = config.symbols;
+    gen.seed = config.seed;
+
+    CompactDFA dfa;
+    rec.phase("generate", [&] {
+        dfa = Generator::generate(gen);
+        return uint64_t(dfa.numStates());
+    });
+    rec.phase("reachable", [&] { return uint64_t(dfa.reachablePart().numStates()); });
+    // The pass every minimize phase starts with; the result is the class count
+    rec.phase("alphabet-classes", [&] { return uint64_t(AlphabetClasses::of(dfa).numClasses()); });
+
+    bool ok = true;
+    CompactDFA minimized;
+    for (MinimizerAlgorithm algorithm : config.algorithms) {
+        MinimizerOptions options;
+        options.algorithm = algorithm;
+        options.threads = config.threads;
+        rec.phase(std::string("minimize:") + Minimizer::name(algorithm), [&] {
+            CompactDFA result = Minimizer::minimize(dfa, options);
+            uint32_t classes = result.numStates();
+            if (minimized.numStates() == 0) minimized = std::move(result);
+            if (family == GeneratorFamily::Minimal && classes != n) {
+                std::cerr << "dfa-bench: " << Minimizer::name(algorithm) << " reduced a minimal automaton of "
+                          << n << " states to " << classes << "\n";
+                ok = false;
+            }
+            return uint64_t(classes);
+        });
+    }
+
+    // Cost of recording the full step timeline on top of a plain run, and of
+    // repeated runs through one workspace, which should allocate nothing
+    if (std::find(config.algorithms.begin(), config.algorithms.end(), MinimizerAlgorithm::Hopcroft) != config.algorithms.end()) {
+        rec.phase("minimize:hopcroft+trace", [&] {
+            HopcroftRecorder recorder(TraceLevel::Full);
+            return uint64_t(Hopcroft::minimize(dfa, recorder).numStates());
+        });
+        HopcroftWorkspace ws;
+        ws.reserve(dfa.numStates(), dfa.numSymbols());
+        std::vector<uint32_t> classOf(dfa.numStates());
+        rec.phase("minimize:hopcroft:reuse", [&] {
+            uint32_t classes = 0;
+            for (int run = 0; run < 3; ++run) classes = Hopcroft::minimize(dfa, classOf, ws);
+            return uint64_t(classes);
+        });
+    }
+
+    // Checking the result costs one union-find pass, not another minimization
+    if (minimized.numStates() > 0) {
+        rec.phase("equivalent", [&] {
+            if (!Equivalence::equivalent(dfa, minimized)) {
+                std::cerr << "dfa-bench: minimized " << Generator::name(family) << " automaton of " << n
+                          << " states accepts a different language\n";
+                ok = false;
+            }
+            return uint64_t(dfa.numStates() + minimized.numStates());
+        });
+        // Each state pairs only with its own class: n reachable pairs out of n·|min|
+        rec.phase("product:intersection", [&] { return uint64_t(Product::build(dfa, minimized, ProductOp::Intersection).numStates()); });
+    }
+
+    QByteArray bytes;
+    if (n <= config.ioMax) {
+        rec.phase("json-write", [&] {
+            bytes.clear();
+            QBuffer buf(&bytes);
+            buf.open(QIODevice::WriteOnly);
+            DFAJsonStream::write(buf, dfa);
+            return uint64_t(bytes.size());
+        });
+        rec.phase("json-read", [&] {
+            QBuffer buf(&bytes);
+            buf.open(QIODevice::ReadOnly);
+            CompactDFA loaded;
+            QString error;
+            return DFAJsonStream::read(buf, loaded, error) ? uint64_t(loaded.numStates()) : 0;
+        });
+    }
+    rec.phase("binary-write", [&] {
+        bytes = DFABinary::toBinary(dfa);
+        return uint64_t(bytes.size());
+    });
+    rec.phase("binary-read", [&] {
+        CompactDFA loaded;
+        QString error;
+        return DFABinary::fromBinary(bytes, loaded, error) ? uint64_t(loaded.numStates()) : 0;
+    });
+    bytes.clear();
+
+    // Matching random lines over the one-byte symbols
+    if (config.matchBytes > 0 && minimized.numStates() > 0) {
+        std::string alphabet;
+        for (const auto& sym : minimized.symbols()) {
+            if (sym.size() == 1) alphabet += sym;
+        }
+        std::string text;
+        text.reserve(config.matchBytes);
+        std::mt19937 rng(uint32_t(config.seed));
+        while (!alphabet.empty() && text.size() < config.matchBytes) {
+            for (uint32_t len = rng() % 64; len > 0; --len) text += alphabet[rng() % alphabet.size()];
+            text += '\n';
+        }
+        CompiledDFA matcher;
+        rec.phase("match:compile", [&] {
+            matcher = CompiledDFA::compile(minimized);
+            return uint64_t(matcher.numStates());
+        });
+        rec.phase("match:lines", [&] {
+            std::vector<uint8_t> results;
+            matcher.acceptsLines(text, results);
+            return uint64_t(text.size());
+        });
+
+        // The same lines as a batch: one-at-a-time walk against the multi-stream kernels
+        std::vector<std::string_view> lines;
+        for (size_t pos = 0, nl; (nl = text.find('\n', pos)) != std::string::npos; pos = nl + 1) {
+            lines.emplace_back(text.data() + pos, nl - pos);
+        }
+        std::vector<uint64_t> bitmap((lines.size() + 63) / 64);
+        for (auto kernel : {MatchKernel::Scalar, MatchKernel::Interleaved, MatchKernel::Avx2}) {
+            if (!CompiledDFA::supported(kernel)) continue;
+            rec.phase(std::string("match:batch:") + CompiledDFA::name(kernel), [&] {
+                matcher.acceptsBitmap(lines.data(), lines.size(), bitmap.data(), kernel);
+                return uint64_t(text.size());
+            });
+        }
+    }
+
+    if (n <= config.layoutMax) {
+        for (auto algorithm : {LayoutAlgorithm::Layered, LayoutAlgorithm::ForceDirected}) {
+            rec.phase(std::string("layout:") + Layout::name(algorithm), [&] {
+                CompactDFA placed = dfa;
+                LayoutOptions options;
+                options.algorithm = algorithm;
+                Layout::apply(placed, options);
+                return uint64_t(placed.numStates());
+            });
+        }
+    }
+
+    // The original map-based model and algorithm, for comparison at small sizes
+    if (n <= config.legacyMax) {
+        DFA legacy;
+        rec.phase("legacy:to-dfa", [&] {
+            legacy = dfa.toDFA();
+            return uint64_t(legacy.states.size());
+        });
+        rec.phase("legacy:remove-unreachable", [&] {
+            DFA copy = legacy;
+            copy.removeUnreachable();
+            return uint64_t(copy.states.size());
+        });
+        rec.phase("legacy:hopcroft-timeline", [&] { return uint64_t(Hopcroft::minimize(legacy).first.states.size()); });
+    }
+    return ok;
+}
+
+void printUsage() {
+    std::cerr << "Usage: dfa-bench [options]\n"
+                 "Generates seeded synthetic automata and reports wall time, peak RSS and\n"
+                 "allocations for every phase as one JSON object per line.\n"
+                 "\n"
+                 "Options:\n"
+                 "  -f, --family <list>     complete, partial, debruijn, cycle, minimal (default: all)\n"
+                 "  -n, --sizes <list>      state counts, e.g. 10,1000,1e6 (default: 10,1000,100000)\n"
+                 "  -k, --symbols <k>       alphabet size (default 2)\n"
+                 "  -a, --algorithm <list>  hopcroft, valmari, parallel (default: all)\n"
+                 "  -t, --threads <n>       worker threads for 'parallel' (0 = all cores)\n"
+                 "  -s, --seed <n>          generator seed (default 1)\n"
+                 "      --legacy-max <n>    largest size for the map-based DFA phases (default 1000)\n"
+                 "      --io-max <n>        largest size for the JSON phases (default 1000000)\n"
+                 "      --match-bytes <n>   input size for the matcher phases, 0 to skip (default 16777216)\n"
+                 "      --layout-max <n>    largest size for the layout phases (default 100000)\n"
+                 "  -l, --label <text>      tag copied into every record, e.g. a commit hash\n"
+                 "  -o, --output <file>     write records to a file instead of stdout\n"
+                 "  -h, --help              show this help\n";
+}
+
+std::vector<std::string> splitList(const std::string& s) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        if (!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+// Accepts plain integers and 1e7-style counts
+bool parseCount(const std::string& s, uint32_t& value) {
+    char* end = nullptr;
+    double d = std::strtod(s.c_str(), &end);
+    if (end == s.c_str() || *end != '\0' || d < 0 || d > 4294967294.0) return false;
+    value = uint32_t(d);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Config config;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else if ((arg == "-f" || arg == "--family") && hasValue) {
+            for (const auto& name : splitList(argv[++i])) {
+                GeneratorFamily family;
+                if (!Generator::parse(name, family)) {
+                    std::cerr << "dfa-bench: unknown family '" << name << "'\n";
+                    return 2;
+                }
+                config.families.push_back(family);
+            }
+        } else if ((arg == "-n" || arg == "--sizes") && hasValue) {
+            config.sizes.clear();
+            for (const auto& size : splitList(argv[++i])) {
+                uint32_t n;
+                if (!parseCount(size, n)) {
+                    std::cerr << "dfa-bench: bad size '" << size << "'\n";
+                    return 2;
+                }
+                config.sizes.push_back(n);
+            }
+        } else if ((arg == "-a" || arg == "--algorithm") && hasValue) {
+            for (const auto& name : splitList(argv[++i])) {
+                MinimizerAlgorithm algorithm;
+                if (!Minimizer::parse(name, algorithm)) {
+                    std::cerr << "dfa-bench: unknown algorithm '" << name << "'\n";
+                    return 2;
+                }
+                config.algorithms.push_back(algorithm);
+            }
+        } else if ((arg == "-k" || arg == "--symbols") && hasValue) {
+            if (!parseCount(argv[++i], config.symbols) || config.symbols == 0) {
+                std::cerr << "dfa-bench: bad symbol count '" << argv[i] << "'\n";
+                return 2;
+            }
+        } else if ((arg == "-t" || arg == "--threads") && hasValue) {
+            config.threads = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        } else if ((arg == "-s" || arg == "--seed") && hasValue) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--legacy-max" && hasValue) {
+            parseCount(argv[++i], config.legacyMax);
+        } else if (arg == "--io-max" && hasValue) {
+            parseCount(argv[++i], config.ioMax);
+        } else if (arg == "--match-bytes" && hasValue) {
+            parseCount(argv[++i], config.matchBytes);
+        } else if (arg == "--layout-max" && hasValue) {
+            parseCount(argv[++i], config.layoutMax);
+        } else if ((arg == "-l" || arg == "--label") && hasValue) {
+            config.label = argv[++i];
+        } else if ((arg == "-o" || arg == "--output") && hasValue) {
+            outputPath = argv[++i];
+        } else {
+            std::cerr << "dfa-bench: unknown option '" << arg << "'\n";
+            printUsage();
+            return 2;
+        }
+    }
+    if (config.families.empty()) {
+        config.families = {GeneratorFamily::RandomComplete, GeneratorFamily::RandomPartial, GeneratorFamily::DeBruijn,
+                           GeneratorFamily::UnaryCycle, GeneratorFamily::Minimal};
+    }
+    if (config.algorithms.empty()) {
+        config.algorithms = {MinimizerAlgorithm::Hopcroft, MinimizerAlgorithm::Valmari, MinimizerAlgorithm::ParallelMoore};
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath);
+        if (!file) {
+            std::cerr << "dfa-bench: cannot write '" << outputPath << "'\n";
+            return 1;
+        }
+    }
+    Recorder rec(outputPath.empty() ? std::cout : file, config);
+
+    bool ok = true;
+    for (GeneratorFamily family : config.families) {
+        for (uint32_t n : config.sizes) ok = runCase(rec, config, family, n) && ok;
+    }
+    return ok ? 0 : 1;
+}
\ No newline at end of file
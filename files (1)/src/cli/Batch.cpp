@@ -0,0 +1,331 @@
+#include "Batch.h"
+#include "algorithms/AlphabetClasses.h"
+#include "algorithms/Hopcroft.h"
+#include "algorithms/Quotient.h"
+#include "io/DFABinary.h"
+#include "io/DFAJsonStream.h"
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+enum class Source { Directory, JsonLines, Records };
+
+struct Item {
+    std::string name;            // file name, or "line N" / "record N"
+    QByteArray input;            // JSON lines: the line itself
+    const uchar* data = nullptr; // records: the record inside the mapped file
+    qint64 size = 0;
+    QByteArray output;           // serialized result; directories write files instead
+    QString error;
+    uint32_t states = 0;
+    uint32_t minStates = 0;
+    double ms = 0.0;
+};
+
+// Per-thread scratch, reused for every item the thread takes
+struct Scratch {
+    HopcroftWorkspace hopcroft;
+    std::vector<uint32_t> classOf;
+};
+
+// Fixed set of workers that drain one chunk of items at a time
+class Pool {
+public:
+    Pool(unsigned threads, std::function<void(Item&, Scratch&)> work) : m_work(std::move(work)) {
+        for (unsigned i = 0; i < threads; ++i) m_threads.emplace_back([this] { worker(); });
+    }
+    ~Pool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& t : m_threads) t.join();
+    }
+
+    // Returns once every item has been processed
+    void run(std::vector<Item>& items) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_items = &items;
+        m_next = 0;
+        m_idle = 0;
+        ++m_generation;
+        m_wake.notify_all();
+        m_done.wait(lock, [&] { return m_idle == m_threads.size(); });
+    }
+
+private:
+    void worker() {
+        Scratch scratch;
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) return;
+            seen = m_generation;
+            std::vector<Item>& items = *m_items;
+            lock.unlock();
+            for (size_t i; (i = m_next.fetch_add(1)) < items.size();) m_work(items[i], scratch);
+            lock.lock();
+            if (++m_idle == m_threads.size()) m_done.notify_one();
+        }
+    }
+
+    std::function<void(Item&, Scratch&)> m_work;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::vector<Item>* m_items = nullptr;
+    std::atomic<size_t> m_next{0};
+    uint64_t m_generation = 0;
+    size_t m_idle = 0;
+    bool m_stop = false;
+};
+
+std::string quoted(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) out += c;
+    }
+    return out + "\"";
+}
+
+bool readFile(const QString& path, CompactDFA& dfa, QString& error) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        error = f.errorString();
+        return false;
+    }
+    if (DFABinary::isBinary(f.peek(4))) {
+        f.close();
+        return DFABinary::load(path, dfa, error);
+    }
+    return DFAJsonStream::read(f, dfa, error);
+}
+
+// Result file for a directory input; x.json and x.dfab both map to one name
+QString outputFile(const std::string& name, bool binary) {
+    return QFileInfo(QString::fromStdString(name)).completeBaseName() + (binary ? ".dfab" : ".json");
+}
+
+bool writeFile(const QString& path, const CompactDFA& dfa, bool binary, QString& error) {
+    if (binary) return DFABinary::save(path, dfa, error);
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly) || !DFAJsonStream::write(f, dfa)) {
+        error = f.errorString();
+        return false;
+    }
+    return true;
+}
+
+// Hopcroft through the thread's workspace; the other engines as usual.
+// The partition is computed over the alphabet classes when they merge
+// anything, and the quotient is taken of the original, so every symbol is
+// back in the result.
+CompactDFA minimize(const CompactDFA& dfa, const MinimizerOptions& options, Scratch& scratch) {
+    if (options.algorithm != MinimizerAlgorithm::Hopcroft) return Minimizer::minimize(dfa, options);
+    if (options.compressAlphabet) {
+        AlphabetClasses classes = AlphabetClasses::of(dfa);
+        if (classes.numClasses() < dfa.numSymbols()) {
+            uint32_t numClasses = Hopcroft::minimize(classes.compress(dfa), scratch.classOf, scratch.hopcroft);
+            return Quotient::build(dfa, scratch.classOf, numClasses);
+        }
+    }
+    uint32_t numClasses = Hopcroft::minimize(dfa, scratch.classOf, scratch.hopcroft);
+    return Quotient::build(dfa, scratch.classOf, numClasses);
+}
+
+} // namespace
+
+bool Batch::run(const std::string& input, const std::string& output, const BatchOptions& options,
+                BatchReport& report, QString& error) {
+    auto started = std::chrono::steady_clock::now();
+    report = BatchReport();
+    const QString inputPath = QString::fromStdString(input);
+    const QString outputPath = QString::fromStdString(output);
+
+    // Pick the source; records are mapped (or, from stdin, read) whole
+    Source source;
+    QFile in;
+    QByteArray records;
+    const uchar* recordData = nullptr;
+    qint64 recordSize = 0;
+    QStringList files;
+    std::map<QString, int> outputCount; // directories: inputs per result file
+    if (input != "-" && QFileInfo(inputPath).isDir()) {
+        source = Source::Directory;
+        files = QDir(inputPath).entryList({"*.json", "*.dfab"}, QDir::Files, QDir::Name);
+        for (const QString& file : files) ++outputCount[outputFile(file.toStdString(), options.binary)];
+    } else {
+        bool opened = input == "-" ? in.open(stdin, QIODevice::ReadOnly)
+                                   : (in.setFileName(inputPath), in.open(QIODevice::ReadOnly));
+        if (!opened) {
+            error = in.errorString();
+            return false;
+        }
+        source = DFABinary::isBinary(in.peek(4)) ? Source::Records : Source::JsonLines;
+        if (source == Source::Records) {
+            recordSize = input == "-" ? 0 : in.size();
+            recordData = recordSize > 0 ? in.map(0, recordSize) : nullptr;
+            if (!recordData) {
+                records = in.readAll();
+                recordData = reinterpret_cast<const uchar*>(records.constData());
+                recordSize = records.size();
+            }
+        }
+    }
+    std::vector<qint64> offsets;
+    if (source == Source::Records && !DFABinary::splitRecords(recordData, recordSize, offsets, error)) return false;
+
+    // Results go to a directory or to one stream
+    QFile out;
+    if (source == Source::Directory) {
+        if (output == "-" || !QDir().mkpath(outputPath)) {
+            error = "A directory input needs an output directory";
+            return false;
+        }
+    } else {
+        bool opened = output == "-" ? out.open(stdout, QIODevice::WriteOnly)
+                                    : (out.setFileName(outputPath), out.open(QIODevice::WriteOnly));
+        if (!opened) {
+            error = out.errorString();
+            return false;
+        }
+    }
+    QFile summary;
+    if (!options.summaryPath.empty()) {
+        summary.setFileName(QString::fromStdString(options.summaryPath));
+        if (!summary.open(QIODevice::WriteOnly)) {
+            error = summary.errorString();
+            return false;
+        }
+    }
+
+    // The pool is the parallelism; engines inside it stay single-threaded
+    MinimizerOptions minimizer = options.minimizer;
+    minimizer.observer = nullptr;
+    minimizer.threads = 1;
+    unsigned jobs = options.jobs ? options.jobs : std::max(1u, std::thread::hardware_concurrency());
+
+    Pool pool(jobs, [&](Item& item, Scratch& scratch) {
+        if (!item.error.isEmpty()) return; // failed before it was queued
+        auto t0 = std::chrono::steady_clock::now();
+        CompactDFA dfa;
+        bool ok = false;
+        if (source == Source::Directory) {
+            ok = readFile(QDir(inputPath).filePath(QString::fromStdString(item.name)), dfa, item.error);
+        } else if (source == Source::JsonLines) {
+            QBuffer buf(&item.input);
+            buf.open(QIODevice::ReadOnly);
+            ok = DFAJsonStream::read(buf, dfa, item.error);
+            item.input.clear();
+        } else {
+            ok = DFABinary::fromBinary(item.data, item.size, dfa, item.error);
+        }
+        if (ok) {
+            item.states = dfa.numStates();
+            if (options.complete) {
+                DFA completed = dfa.toDFA();
+                completed.completeWithSink();
+                dfa = CompactDFA::fromDFA(completed);
+            }
+            CompactDFA minDFA = minimize(dfa, minimizer, scratch);
+            item.minStates = minDFA.numStates();
+            if (options.layout) Layout::apply(minDFA, options.layoutOptions);
+
+            if (source == Source::Directory) {
+                ok = writeFile(QDir(outputPath).filePath(outputFile(item.name, options.binary)), minDFA,
+                               options.binary, item.error);
+            } else {
+                QBuffer buf(&item.output);
+                buf.open(QIODevice::WriteOnly);
+                if (source == Source::JsonLines) {
+                    ok = DFAJsonStream::write(buf, minDFA, DFAJsonStream::Compact) && buf.write("\n", 1) == 1;
+                } else {
+                    ok = DFABinary::writeRecord(buf, minDFA, item.error);
+                }
+            }
+        }
+        if (!ok && item.error.isEmpty()) item.error = "Cannot write the result";
+        item.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    });
+
+    // Read a chunk, minimize it in parallel, write it in order
+    const size_t chunkSize = 64 * size_t(jobs);
+    size_t next = 0;     // next file or record
+    size_t lineNo = 0;
+    std::vector<Item> items;
+    while (true) {
+        items.clear();
+        while (items.size() < chunkSize) {
+            Item item;
+            if (source == Source::Directory) {
+                if (next == size_t(files.size())) break;
+                item.name = files[int(next++)].toStdString();
+                QString file = outputFile(item.name, options.binary);
+                if (outputCount[file] > 1) item.error = "Another input also writes " + file;
+            } else if (source == Source::Records) {
+                if (next == offsets.size()) break;
+                qint64 end = next + 1 < offsets.size() ? offsets[next + 1] : recordSize;
+                item.name = "record " + std::to_string(next + 1);
+                item.data = recordData + offsets[next];
+                item.size = end - offsets[next];
+                ++next;
+            } else {
+                if (in.atEnd()) break;
+                item.input = in.readLine();
+                ++lineNo;
+                if (item.input.trimmed().isEmpty()) continue;
+                item.name = "line " + std::to_string(lineNo);
+            }
+            items.push_back(std::move(item));
+        }
+        if (items.empty()) break;
+        pool.run(items);
+
+        for (const Item& item : items) {
+            bool ok = item.error.isEmpty();
+            if (ok && source != Source::Directory && out.write(item.output) != item.output.size()) {
+                error = out.errorString();
+                return false;
+            }
+            if (!ok) ++report.failed;
+            if (summary.isOpen()) {
+                std::string line = "{\"index\":" + std::to_string(report.items) + ",\"name\":" + quoted(item.name) +
+                                   ",\"ok\":" + (ok ? "true" : "false");
+                if (ok) {
+                    line += ",\"states\":" + std::to_string(item.states) +
+                            ",\"minStates\":" + std::to_string(item.minStates);
+                } else {
+                    line += ",\"error\":" + quoted(item.error.toStdString());
+                }
+                line += ",\"ms\":" + std::to_string(item.ms) + "}\n";
+                summary.write(line.data(), qint64(line.size()));
+            }
+            ++report.items;
+        }
+    }
+
+    report.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    if (summary.isOpen()) {
+        std::string line = "{\"items\":" + std::to_string(report.items) + ",\"failed\":" + std::to_string(report.failed) +
+                           ",\"threads\":" + std::to_string(jobs) + ",\"ms\":" + std::to_string(report.ms) + "}\n";
+        summary.write(line.data(), qint64(line.size()));
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#include "algorithms/Minimizer.h"
+#include "layout/Layout.h"
+#include <QString>
+#include <cstddef>
+#include <string>
+
+struct BatchOptions {
+    MinimizerOptions minimizer;  // observer is ignored; ParallelMoore runs single-threaded
+    bool complete = false;       // complete each automaton with a sink first
+    bool layout = false;
+    LayoutOptions layoutOptions;
+    unsigned jobs = 0;           // worker threads; 0 = all hardware threads
+    bool binary = false;         // directory input: write .dfab files instead of JSON
+    std::string summaryPath;     // per-item report as JSON lines; empty = none
+};
+
+struct BatchReport {
+    size_t items = 0;
+    size_t failed = 0;
+    double ms = 0.0;
+};
+
+// Minimizes many automata on a pool of worker threads, each with its own
+// Hopcroft workspace. The input is one of
+//   - a directory: every *.json and *.dfab file in name order; the results
+//     go to the output directory under the same names,
+//   - newline-delimited JSON (a file, or "-" for stdin): one automaton per
+//     line; the results are written the same way,
+//   - a multi-record binary file (see DFABinary::writeRecord); the results
+//     are written as one too.
+// Items are read and minimized a chunk at a time, so a stream of any length
+// runs in bounded memory, and results are always written in input order.
+// An item that fails is reported in the summary and left out of the output.
+class Batch {
+public:
+    // False only when the batch as a whole could not run; per-item failures
+    // are counted in report
+    static bool run(const std::string& input, const std::string& output, const BatchOptions& options,
+                    BatchReport& report, QString& error);
+};
\ No newline at end of file
@@ -0,0 +1,303 @@
+// dfa-min: headless minimizer for batch pipelines. Links the core library
+// only, so it starts without a GUI stack or display.
+#include "model/DFA.h"
+#include "algorithms/AlphabetClasses.h"
+#include "algorithms/Minimizer.h"
+#include "algorithms/Equivalence.h"
+#include "algorithms/HopcroftTrace.h"
+#include "algorithms/Product.h"
+#include "algorithms/SubsetConstruction.h"
+#include "io/DFAJsonStream.h"
+#include "io/DFABinary.h"
+#include "io/Regex.h"
+#include "layout/Layout.h"
+#include "Batch.h"
+#include <QFile>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage: dfa-min [options] <input|-> [output|-]\n"
+                 "Reads an automaton, minimizes it and writes the result (stdout by default).\n"
+                 "Input may be JSON or binary (.dfab, detected by its header); output is\n"
+                 "binary when the output name ends in .dfab or --binary is given.\n"
+                 "\n"
+                 "With --batch the input is a directory of .json/.dfab files (output: a\n"
+                 "directory), newline-delimited JSON (a file or stdin) or a multi-record\n"
+                 "binary file; results come out in the same form and in input order.\n"
+                 "\n"
+                 "Options:\n"
+                 "  -a, --algorithm <name>  hopcroft (default), valmari or parallel\n"
+                 "  -t, --threads <n>       worker threads for 'parallel' (0 = all cores)\n"
+                 "  -n, --nfa               read JSON as an NFA (ε = \"\" or \"ε\") and determinize it\n"
+                 "  -r, --regex             the input is regular expressions, one per line,\n"
+                 "                          compiled as their alternation\n"
+                 "  -c, --complete          complete with a sink state before minimizing\n"
+                 "  -p, --product <op> <file>  combine with <file> first: intersection, union,\n"
+                 "                          xor or difference (only reachable pairs are built)\n"
+                 "      --complement        complement the input (after any --product)\n"
+                 "  -b, --binary            write the binary format\n"
+                 "  -l, --layout <name>     place the result's states: layered or force\n"
+                 "  -s, --stats             print a summary of the run to stderr\n"
+                 "      --verify            check the result against the input (equivalence test)\n"
+                 "      --equiv <file>      only compare languages with <file>; exit 1 if they differ\n"
+                 "      --subset-of <file>  only check that <file> accepts all the input accepts\n"
+                 "  -B, --batch             minimize many automata on a thread pool\n"
+                 "  -j, --jobs <n>          batch worker threads (0 = all cores)\n"
+                 "      --summary <file>    batch: per-item timing and failures as JSON lines\n"
+                 "  -h, --help              show this help\n";
+}
+
+bool openFile(QFile& f, const std::string& path, QIODevice::OpenMode mode) {
+    if (path == "-") return f.open(mode == QIODevice::ReadOnly ? stdin : stdout, mode);
+    f.setFileName(QString::fromStdString(path));
+    return f.open(mode);
+}
+
+// JSON (streamed) or binary (memory-mapped), from a file or stdin. With nfa
+// the JSON is read as an NFA and determinized; binary files are DFAs anyway.
+bool readAutomaton(const std::string& path, CompactDFA& dfa, QString& error, bool nfa = false) {
+    QFile f;
+    if (!openFile(f, path, QIODevice::ReadOnly)) {
+        error = f.errorString();
+        return false;
+    }
+    if (DFABinary::isBinary(f.peek(4))) {
+        if (path == "-") return DFABinary::fromBinary(f.readAll(), dfa, error);
+        f.close();
+        return DFABinary::load(QString::fromStdString(path), dfa, error);
+    }
+    if (nfa) {
+        NFA source;
+        if (!DFAJsonStream::read(f, source, error)) return false;
+        dfa = SubsetConstruction::determinize(source);
+        return true;
+    }
+    return DFAJsonStream::read(f, dfa, error);
+}
+
+bool readPatterns(const std::string& path, CompactDFA& dfa, QString& error) {
+    QFile f;
+    if (!openFile(f, path, QIODevice::ReadOnly)) {
+        error = f.errorString();
+        return false;
+    }
+    return Regex::read(f, dfa, error);
+}
+
+bool writeAutomaton(const std::string& path, const CompactDFA& dfa, bool binary, QString& error) {
+    QFile f;
+    if (!openFile(f, path, QIODevice::WriteOnly)) {
+        error = f.errorString();
+        return false;
+    }
+    bool ok = binary ? DFABinary::write(f, dfa, error) : DFAJsonStream::write(f, dfa);
+    if (!ok && error.isEmpty()) error = f.errorString();
+    return ok;
+}
+
+bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// A word as its symbols separated by spaces; "" for the empty word
+std::string quotedWord(const std::vector<std::string>& word) {
+    std::string out = "\"";
+    for (size_t i = 0; i < word.size(); ++i) out += (i ? " " : "") + word[i];
+    return out + "\"";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    MinimizerOptions options;
+    bool complete = false;
+    bool binary = false;
+    bool stats = false;
+    bool layout = false;
+    LayoutOptions layoutOptions;
+    bool verify = false;
+    std::string comparePath;
+    bool inclusion = false;
+    std::string productPath;
+    ProductOp productOp = ProductOp::Intersection;
+    bool complement = false;
+    bool nfa = false;
+    bool regex = false;
+    bool batch = false;
+    BatchOptions batchOptions;
+    std::string inputPath, outputPath = "-";
+    int positional = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else if ((arg == "-a" || arg == "--algorithm") && i + 1 < argc) {
+            if (!Minimizer::parse(argv[++i], options.algorithm)) {
+                std::cerr << "dfa-min: unknown algorithm '" << argv[i] << "'\n";
+                return 2;
+            }
+        } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+            options.threads = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "-n" || arg == "--nfa") {
+            nfa = true;
+        } else if (arg == "-r" || arg == "--regex") {
+            regex = true;
+        } else if (arg == "-c" || arg == "--complete") {
+            complete = true;
+        } else if ((arg == "-p" || arg == "--product") && i + 2 < argc) {
+            if (!Product::parse(argv[++i], productOp)) {
+                std::cerr << "dfa-min: unknown product '" << argv[i] << "'\n";
+                return 2;
+            }
+            productPath = argv[++i];
+        } else if (arg == "--complement") {
+            complement = true;
+        } else if (arg == "-b" || arg == "--binary") {
+            binary = true;
+        } else if ((arg == "-l" || arg == "--layout") && i + 1 < argc) {
+            if (!Layout::parse(argv[++i], layoutOptions.algorithm)) {
+                std::cerr << "dfa-min: unknown layout '" << argv[i] << "'\n";
+                return 2;
+            }
+            layout = true;
+        } else if (arg == "-s" || arg == "--stats") {
+            stats = true;
+        } else if (arg == "--verify") {
+            verify = true;
+        } else if ((arg == "--equiv" || arg == "--subset-of") && i + 1 < argc) {
+            comparePath = argv[++i];
+            inclusion = arg == "--subset-of";
+        } else if (arg == "-B" || arg == "--batch") {
+            batch = true;
+        } else if ((arg == "-j" || arg == "--jobs") && i + 1 < argc) {
+            batchOptions.jobs = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--summary" && i + 1 < argc) {
+            batchOptions.summaryPath = argv[++i];
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "dfa-min: unknown option '" << arg << "'\n";
+            printUsage();
+            return 2;
+        } else if (positional == 0) {
+            inputPath = arg;
+            ++positional;
+        } else if (positional == 1) {
+            outputPath = arg;
+            ++positional;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (inputPath.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    QString error;
+    if (batch && (!productPath.empty() || complement || nfa || regex)) {
+        std::cerr << "dfa-min: --product, --complement, --nfa and --regex take a single automaton, not --batch\n";
+        return 2;
+    }
+    if (batch) {
+        batchOptions.minimizer = options;
+        batchOptions.complete = complete;
+        batchOptions.layout = layout;
+        batchOptions.layoutOptions = layoutOptions;
+        batchOptions.binary = binary;
+        BatchReport report;
+        if (!Batch::run(inputPath, outputPath, batchOptions, report, error)) {
+            std::cerr << "dfa-min: " << inputPath << ": " << error.toStdString() << "\n";
+            return 1;
+        }
+        if (stats || report.failed > 0) {
+            std::cerr << "dfa-min: " << report.items << " automata, " << report.failed << " failed, "
+                      << report.ms << " ms (" << Minimizer::name(options.algorithm) << ")\n";
+        }
+        return report.failed > 0 ? 1 : 0;
+    }
+
+    CompactDFA dfa;
+    if (regex ? !readPatterns(inputPath, dfa, error) : !readAutomaton(inputPath, dfa, error, nfa)) {
+        std::cerr << "dfa-min: " << inputPath << ": " << error.toStdString() << "\n";
+        return 1;
+    }
+    if (!comparePath.empty()) {
+        // CI gate: no minimization, just the language check and a witness
+        CompactDFA other;
+        if (!readAutomaton(comparePath, other, error, nfa)) {
+            std::cerr << "dfa-min: " << comparePath << ": " << error.toStdString() << "\n";
+            return 1;
+        }
+        std::vector<std::string> word;
+        bool holds = inclusion ? Equivalence::included(dfa, other, &word) : Equivalence::equivalent(dfa, other, &word);
+        if (!holds) {
+            std::cerr << "dfa-min: " << (inclusion ? "not included" : "languages differ") << ", shortest witness: "
+                      << quotedWord(word) << "\n";
+        } else if (stats) {
+            std::cerr << "dfa-min: " << (inclusion ? "included" : "equivalent") << "\n";
+        }
+        return holds ? 0 : 1;
+    }
+    if (!productPath.empty()) {
+        // Only the reachable product is built; the minimizer below sees nothing else
+        CompactDFA other;
+        if (!readAutomaton(productPath, other, error, nfa)) {
+            std::cerr << "dfa-min: " << productPath << ": " << error.toStdString() << "\n";
+            return 1;
+        }
+        dfa = Product::build(dfa, other, productOp);
+    }
+    if (complement) dfa = Product::complement(dfa);
+    if (complete) {
+        DFA completed = dfa.toDFA();
+        completed.completeWithSink();
+        dfa = CompactDFA::fromDFA(completed);
+    }
+
+    // Counters only: the run stays free of per-step recording. The minimizer
+    // keeps the full alphabet for an observer, so the stats run compresses
+    // here to time (and count) the same run as without --stats.
+    HopcroftRecorder summary(TraceLevel::Summary);
+    if (stats) options.observer = &summary;
+    auto started = std::chrono::steady_clock::now();
+    AlphabetClasses classes;
+    bool narrow = false;
+    if (stats && options.compressAlphabet) {
+        classes = AlphabetClasses::of(dfa);
+        narrow = classes.numClasses() < dfa.numSymbols();
+    }
+    CompactDFA minDFA = narrow ? classes.expand(Minimizer::minimize(classes.compress(dfa), options), dfa)
+                               : Minimizer::minimize(dfa, options);
+    if (stats) {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        std::cerr << "dfa-min: " << dfa.numStates() << " -> " << minDFA.numStates() << " states in " << ms
+                  << " ms (" << Minimizer::name(options.algorithm) << ")\n";
+        if (options.algorithm == MinimizerAlgorithm::Hopcroft) {
+            const HopcroftStats& s = summary.trace().stats;
+            std::cerr << "dfa-min: " << s.splitters << " splitters, " << s.steps << " steps, " << s.splits
+                      << " splits, " << s.moved << " states moved, worklist peak " << s.maxWorklist << "\n";
+        }
+    }
+    if (verify) {
+        std::vector<std::string> word;
+        if (!Equivalence::equivalent(dfa, minDFA, &word)) {
+            std::cerr << "dfa-min: result differs from the input on " << quotedWord(word) << "\n";
+            return 1;
+        }
+    }
+    if (layout) Layout::apply(minDFA, layoutOptions);
+    binary = binary || endsWith(outputPath, ".dfab");
+    if (!writeAutomaton(outputPath, minDFA, binary, error)) {
+        std::cerr << "dfa-min: cannot write '" << outputPath << "': " << error.toStdString() << "\n";
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,364 @@
+#include "DFABinary.h"
+#include <QBuffer>
+#include <QtEndian>
+#include <QSysInfo>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char Magic[4] = {'D', 'F', 'A', 'B'};
+const qint64 HeaderSize = 80;
+
+quint64 align8(quint64 v) { return (v + 7) & ~quint64(7); }
+
+quint64 stringTableSize(size_t count, quint64 bytes) { return align8(4 * (quint64(count) + 1) + bytes); }
+
+// Buffered little-endian writer; keeps memory flat for large tables
+class Writer {
+public:
+    explicit Writer(QIODevice& out) : m_out(out) { m_buf.reserve(1 << 16); }
+    ~Writer() { flush(); }
+
+    void bytes(const void* p, size_t n) {
+        m_buf.append(static_cast<const char*>(p), qsizetype(n));
+        m_written += n;
+        if (m_buf.size() >= (1 << 16)) flush();
+    }
+    void u32(quint32 v) { v = qToLittleEndian(v); bytes(&v, 4); }
+    void u64(quint64 v) { v = qToLittleEndian(v); bytes(&v, 8); }
+    void f64(double d) { quint64 v; std::memcpy(&v, &d, 8); u64(v); }
+    void pad8() { while (m_written % 8) { char z = 0; bytes(&z, 1); } }
+    bool flush() {
+        if (!m_buf.isEmpty()) {
+            m_ok = m_ok && m_out.write(m_buf) == m_buf.size();
+            m_buf.clear();
+        }
+        return m_ok;
+    }
+
+private:
+    QIODevice& m_out;
+    QByteArray m_buf;
+    quint64 m_written = 0;
+    bool m_ok = true;
+};
+
+template <class Get>
+void writeStrings(Writer& w, size_t count, Get get) {
+    quint32 offset = 0;
+    w.u32(0);
+    for (size_t i = 0; i < count; ++i) {
+        offset += quint32(get(i).size());
+        w.u32(offset);
+    }
+    for (size_t i = 0; i < count; ++i) w.bytes(get(i).data(), get(i).size());
+    w.pad8();
+}
+
+void writeBits(Writer& w, const Bitset& bits) {
+    for (quint64 word : bits.words()) w.u64(word);
+}
+
+quint32 readU32(const uchar* p) { return qFromLittleEndian<quint32>(p); }
+quint64 readU64(const uchar* p) { return qFromLittleEndian<quint64>(p); }
+
+// True when the offsets never decrease and the last string ends inside the
+// section; stringAt relies on it
+bool validStrings(const uchar* section, quint64 sectionSize, uint32_t count) {
+    quint64 prev = 0;
+    for (quint64 i = 0; i <= count; ++i) {
+        quint64 offset = readU32(section + 4 * i);
+        if (offset < prev) return false;
+        prev = offset;
+    }
+    return 4 * (quint64(count) + 1) + prev <= sectionSize;
+}
+
+std::string_view stringAt(const uchar* section, uint32_t count, uint32_t i) {
+    quint64 begin = readU32(section + 4 * quint64(i));
+    quint64 end = readU32(section + 4 * (quint64(i) + 1));
+    quint64 base = 4 * (quint64(count) + 1);
+    return std::string_view(reinterpret_cast<const char*>(section + base + begin), size_t(end - begin));
+}
+
+} // namespace
+
+bool DFABinary::write(QIODevice& out, const CompactDFA& dfa, QString& error) {
+    const uint32_t n = dfa.numStates();
+    const uint32_t k = dfa.numSymbols();
+
+    quint64 symbolBytes = 0, stateBytes = 0;
+    for (uint32_t a = 0; a < k; ++a) symbolBytes += dfa.symbol(a).size();
+    for (uint32_t q = 0; q < n; ++q) stateBytes += dfa.stateId(q).size();
+    if (symbolBytes > 0xFFFFFFFFull || stateBytes > 0xFFFFFFFFull) {
+        error = "String table exceeds 4 GiB";
+        return false;
+    }
+    quint64 bitsetBytes = 8 * ((quint64(n) + 63) / 64);
+
+    quint64 symbolsOffset = HeaderSize;
+    quint64 statesOffset = symbolsOffset + stringTableSize(k, symbolBytes);
+    quint64 acceptOffset = statesOffset + stringTableSize(n, stateBytes);
+    quint64 startOffset = acceptOffset + bitsetBytes;
+    quint64 layoutOffset = startOffset + bitsetBytes;
+    quint64 deltaOffset = layoutOffset + 16 * quint64(n);
+    quint64 fileSize = deltaOffset + 4 * quint64(n) * k;
+
+    Writer w(out);
+    w.bytes(Magic, 4);
+    w.u32(Version);
+    w.u32(n);
+    w.u32(k);
+    w.u32(HasLayout);
+    w.u32(0);
+    w.u64(symbolsOffset);
+    w.u64(statesOffset);
+    w.u64(acceptOffset);
+    w.u64(startOffset);
+    w.u64(layoutOffset);
+    w.u64(deltaOffset);
+    w.u64(fileSize);
+
+    writeStrings(w, k, [&](size_t a) -> const std::string& { return dfa.symbol(uint32_t(a)); });
+    writeStrings(w, n, [&](size_t q) -> const std::string& { return dfa.stateId(uint32_t(q)); });
+    writeBits(w, dfa.acceptSet());
+    writeBits(w, dfa.startSet());
+    for (uint32_t q = 0; q < n; ++q) w.f64(dfa.x(q));
+    for (uint32_t q = 0; q < n; ++q) w.f64(dfa.y(q));
+    if (QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
+        w.bytes(dfa.table().data(), dfa.table().size() * 4);
+    } else {
+        for (uint32_t t : dfa.table()) w.u32(t);
+    }
+
+    if (!w.flush()) {
+        error = out.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool DFABinary::save(const QString& path, const CompactDFA& dfa, QString& error) {
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly)) {
+        error = f.errorString();
+        return false;
+    }
+    return write(f, dfa, error);
+}
+
+QByteArray DFABinary::toBinary(const CompactDFA& dfa) {
+    QByteArray data;
+    QBuffer buf(&data);
+    buf.open(QIODevice::WriteOnly);
+    QString error;
+    write(buf, dfa, error);
+    return data;
+}
+
+bool DFABinary::load(const QString& path, CompactDFA& dfa, QString& error) {
+    MappedDFA mapped;
+    return mapped.open(path, error) && mapped.toCompact(dfa, error);
+}
+
+bool DFABinary::fromBinary(const QByteArray& data, CompactDFA& dfa, QString& error) {
+    return fromBinary(reinterpret_cast<const uchar*>(data.constData()), data.size(), dfa, error);
+}
+
+bool DFABinary::fromBinary(const uchar* data, qint64 size, CompactDFA& dfa, QString& error) {
+    MappedDFA view;
+    bool ok = view.attach(data, size, error) && view.toCompact(dfa, error);
+    view.m_data = nullptr; // not ours to unmap
+    return ok;
+}
+
+bool DFABinary::writeRecord(QIODevice& out, const CompactDFA& dfa, QString& error) {
+    if (!write(out, dfa, error)) return false;
+    // Everything before the table is 8-aligned, so only the table can leave a remainder
+    if ((quint64(dfa.numStates()) * dfa.numSymbols()) % 2 == 0) return true;
+    const char pad[4] = {0, 0, 0, 0};
+    if (out.write(pad, 4) != 4) {
+        error = out.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool DFABinary::splitRecords(const uchar* data, qint64 size, std::vector<qint64>& offsets, QString& error) {
+    offsets.clear();
+    for (qint64 pos = 0; pos < size;) {
+        if (size - pos < HeaderSize || std::memcmp(data + pos, Magic, 4) != 0) {
+            error = QString("Bad record header at byte %1").arg(pos);
+            return false;
+        }
+        quint64 recordSize = readU64(data + pos + 72);
+        if (recordSize < quint64(HeaderSize) || recordSize > quint64(size - pos)) {
+            error = QString("Truncated record at byte %1").arg(pos);
+            return false;
+        }
+        offsets.push_back(pos);
+        pos += qint64(std::min(align8(recordSize), quint64(size - pos)));
+    }
+    return true;
+}
+
+bool DFABinary::isBinary(const QByteArray& data) {
+    return data.size() >= 4 && std::memcmp(data.constData(), Magic, 4) == 0;
+}
+
+bool MappedDFA::open(const QString& path, QString& error) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        error = m_file.errorString();
+        return false;
+    }
+    qint64 size = m_file.size();
+    const uchar* data = size > 0 ? m_file.map(0, size) : nullptr;
+    if (!data) {
+        error = size > 0 ? "Cannot map file: " + m_file.errorString() : QString("File is empty");
+        m_file.close();
+        return false;
+    }
+    if (!attach(data, size, error)) {
+        m_file.unmap(const_cast<uchar*>(data));
+        m_file.close();
+        m_data = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void MappedDFA::close() {
+    if (m_data && m_file.isOpen()) m_file.unmap(const_cast<uchar*>(m_data));
+    if (m_file.isOpen()) m_file.close();
+    m_data = nullptr;
+    m_size = 0;
+    m_numStates = m_numSymbols = 0;
+}
+
+bool MappedDFA::attach(const uchar* data, qint64 size, QString& error) {
+    if (size < HeaderSize || std::memcmp(data, Magic, 4) != 0) {
+        error = "Not a binary DFA file";
+        return false;
+    }
+    if (readU32(data + 4) != DFABinary::Version) {
+        error = QString("Unsupported binary DFA version %1").arg(readU32(data + 4));
+        return false;
+    }
+    uint32_t n = readU32(data + 8);
+    uint32_t k = readU32(data + 12);
+    m_flags = readU32(data + 16);
+    m_symbolsOffset = readU64(data + 24);
+    m_statesOffset = readU64(data + 32);
+    m_acceptOffset = readU64(data + 40);
+    m_startOffset = readU64(data + 48);
+    m_layoutOffset = readU64(data + 56);
+    m_deltaOffset = readU64(data + 64);
+    quint64 fileSize = readU64(data + 72);
+
+    quint64 bitsetBytes = 8 * ((quint64(n) + 63) / 64);
+    // Bounding every offset by the file size first keeps the sums below from
+    // wrapping; the table size n·k·4 can, so it is compared by division
+    bool ok = fileSize <= quint64(size) &&
+              m_symbolsOffset <= fileSize && m_statesOffset <= fileSize && m_acceptOffset <= fileSize &&
+              m_startOffset <= fileSize && m_layoutOffset <= fileSize && m_deltaOffset <= fileSize &&
+              m_symbolsOffset >= quint64(HeaderSize) &&
+              m_statesOffset >= m_symbolsOffset + 4 * (quint64(k) + 1) &&
+              m_acceptOffset >= m_statesOffset + 4 * (quint64(n) + 1) &&
+              m_startOffset >= m_acceptOffset + bitsetBytes &&
+              m_layoutOffset >= m_startOffset + bitsetBytes &&
+              m_deltaOffset >= m_layoutOffset + ((m_flags & DFABinary::HasLayout) ? 16 * quint64(n) : 0) &&
+              quint64(n) * k <= (fileSize - m_deltaOffset) / 4 &&
+              m_deltaOffset % 4 == 0;
+    if (!ok) {
+        error = "Truncated or corrupt binary DFA file";
+        return false;
+    }
+    if (!validStrings(data + m_symbolsOffset, m_statesOffset - m_symbolsOffset, k) ||
+        !validStrings(data + m_statesOffset, m_acceptOffset - m_statesOffset, n)) {
+        error = "Corrupt string table in binary DFA file";
+        return false;
+    }
+
+    m_data = data;
+    m_size = size;
+    m_numStates = n;
+    m_numSymbols = k;
+    return true;
+}
+
+uint32_t MappedDFA::next(uint32_t q, uint32_t a) const {
+    return readU32(m_data + m_deltaOffset + 4 * (quint64(q) * m_numSymbols + a));
+}
+
+bool MappedDFA::isAccept(uint32_t q) const {
+    return (readU64(m_data + m_acceptOffset + 8 * (q >> 6)) >> (q & 63)) & 1;
+}
+
+bool MappedDFA::isStart(uint32_t q) const {
+    return (readU64(m_data + m_startOffset + 8 * (q >> 6)) >> (q & 63)) & 1;
+}
+
+std::string_view MappedDFA::stateId(uint32_t q) const {
+    return stringAt(m_data + m_statesOffset, m_numStates, q);
+}
+
+std::string_view MappedDFA::symbol(uint32_t a) const {
+    return stringAt(m_data + m_symbolsOffset, m_numSymbols, a);
+}
+
+bool MappedDFA::toCompact(CompactDFA& dfa, QString& error) const {
+    const uint32_t n = m_numStates;
+    const uint32_t k = m_numSymbols;
+    dfa.clear();
+    dfa.reserve(n, k);
+    for (uint32_t a = 0; a < k; ++a) {
+        std::string sym(symbol(a));
+        if (dfa.addSymbol(sym) != a) {
+            error = "Duplicate symbol in binary DFA file";
+            return false;
+        }
+    }
+
+    // One bulk copy per table instead of per-state/per-transition inserts
+    size_t cells = size_t(n) * k;
+    dfa.m_delta.resize(cells);
+    std::memcpy(dfa.m_delta.data(), m_data + m_deltaOffset, cells * 4);
+    if (QSysInfo::ByteOrder != QSysInfo::LittleEndian) {
+        for (auto& t : dfa.m_delta) t = qFromLittleEndian(t);
+    }
+    for (uint32_t t : dfa.m_delta) {
+        if (t != CompactDFA::NONE && t >= n) {
+            error = "Transition target out of range in binary DFA file";
+            dfa.clear();
+            return false;
+        }
+    }
+
+    dfa.m_accept.resize(n);
+    dfa.m_start.resize(n);
+    for (size_t i = 0; i < dfa.m_accept.words().size(); ++i) {
+        dfa.m_accept.words()[i] = readU64(m_data + m_acceptOffset + 8 * i);
+        dfa.m_start.words()[i] = readU64(m_data + m_startOffset + 8 * i);
+    }
+    dfa.m_accept.resize(n); // clears stray bits past the end
+    dfa.m_start.resize(n);
+
+    dfa.m_stateIds.resize(n);
+    dfa.m_x.assign(n, 0.0);
+    dfa.m_y.assign(n, 0.0);
+    bool layout = (m_flags & DFABinary::HasLayout) != 0;
+    for (uint32_t q = 0; q < n; ++q) {
+        dfa.m_stateIds[q] = std::string(stateId(q));
+        dfa.m_stateIndex.emplace(dfa.m_stateIds[q], q);
+        if (layout) {
+            quint64 x = readU64(m_data + m_layoutOffset + 8 * quint64(q));
+            quint64 y = readU64(m_data + m_layoutOffset + 8 * (quint64(n) + q));
+            std::memcpy(&dfa.m_x[q], &x, 8);
+            std::memcpy(&dfa.m_y[q], &y, 8);
+        }
+    }
+    return true;
+}
\ No newline at end of file
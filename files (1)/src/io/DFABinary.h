@@ -0,0 +1,92 @@
+#pragma once
+#include "../model/CompactDFA.h"
+#include <QByteArray>
+#include <QFile>
+#include <QIODevice>
+#include <QString>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Versioned binary automaton format (.dfab). All integers are little-endian
+// and every section starts on an 8-byte boundary:
+//
+//   header        magic "DFAB", version, state/symbol counts, flags and the
+//                 absolute offset of every section
+//   symbols       uint32 offsets[numSymbols + 1], then the UTF-8 bytes
+//   state ids     uint32 offsets[numStates + 1], then the UTF-8 bytes
+//   accept, start bitsets as uint64 words
+//   layout        double x[numStates], y[numStates] (only with HasLayout)
+//   delta         uint32 delta[numStates * numSymbols], 0xFFFFFFFF = none
+//
+// Transitions outside the table (CompactDFA::foreignTransitions) are not stored.
+//
+// A multi-record file holds complete images back to back, each padded to a
+// multiple of 8 bytes so the next one starts aligned.
+class DFABinary {
+public:
+    static constexpr uint32_t Version = 1;
+    static constexpr uint32_t HasLayout = 1;
+
+    static bool write(QIODevice& out, const CompactDFA& dfa, QString& error);
+    static bool save(const QString& path, const CompactDFA& dfa, QString& error);
+    static QByteArray toBinary(const CompactDFA& dfa);
+
+    // Maps the file and copies it into dfa with one allocation per table
+    static bool load(const QString& path, CompactDFA& dfa, QString& error);
+    static bool fromBinary(const QByteArray& data, CompactDFA& dfa, QString& error);
+    static bool fromBinary(const uchar* data, qint64 size, CompactDFA& dfa, QString& error);
+
+    // One record of a multi-record file: write() plus the padding
+    static bool writeRecord(QIODevice& out, const CompactDFA& dfa, QString& error);
+    // Start offset of every record in data; only the size field of each
+    // header is checked here, fromBinary() validates the rest
+    static bool splitRecords(const uchar* data, qint64 size, std::vector<qint64>& offsets, QString& error);
+
+    // True when data starts with the binary magic
+    static bool isBinary(const QByteArray& data);
+};
+
+// Read-only, zero-copy view of a .dfab file mapped into memory. Opening only
+// validates the header, so it costs the same for ten states or ten million,
+// and the OS page cache shares the pages between processes.
+class MappedDFA {
+public:
+    MappedDFA() = default;
+    ~MappedDFA() { close(); }
+    MappedDFA(const MappedDFA&) = delete;
+    MappedDFA& operator=(const MappedDFA&) = delete;
+
+    bool open(const QString& path, QString& error);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    uint32_t numStates() const { return m_numStates; }
+    uint32_t numSymbols() const { return m_numSymbols; }
+    uint32_t next(uint32_t q, uint32_t a) const;
+    bool isAccept(uint32_t q) const;
+    bool isStart(uint32_t q) const;
+    std::string_view stateId(uint32_t q) const;
+    std::string_view symbol(uint32_t a) const;
+
+    // Copies the mapped automaton into a CompactDFA; fails on out-of-range targets
+    bool toCompact(CompactDFA& dfa, QString& error) const;
+
+private:
+    friend class DFABinary;
+    // Validates a header and section bounds for an in-memory image
+    bool attach(const uchar* data, qint64 size, QString& error);
+
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+    uint32_t m_numStates = 0;
+    uint32_t m_numSymbols = 0;
+    uint32_t m_flags = 0;
+    quint64 m_symbolsOffset = 0;
+    quint64 m_statesOffset = 0;
+    quint64 m_acceptOffset = 0;
+    quint64 m_startOffset = 0;
+    quint64 m_layoutOffset = 0;
+    quint64 m_deltaOffset = 0;
+};
\ No newline at end of file
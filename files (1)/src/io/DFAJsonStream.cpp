@@ -0,0 +1,570 @@
+#include "DFAJsonStream.h"
+#include <QByteArray>
+#include <QLocale>
+#include <cmath>
+
+namespace {
+
+const qint64 BufferSize = 1 << 16;
+
+// Pull parser over a QIODevice; only the current window and the current
+// string token are ever in memory
+class Reader {
+public:
+    explicit Reader(QIODevice& in) : m_in(in) { m_buf.resize(BufferSize); }
+
+    int peek() {
+        if (m_pos == m_len && !fill()) return -1;
+        return static_cast<unsigned char>(m_buf[m_pos]);
+    }
+    int get() {
+        int c = peek();
+        if (c >= 0) ++m_pos;
+        return c;
+    }
+    // A leading UTF-8 byte order mark, which QJsonDocument::fromJson skips too
+    bool skipBom() {
+        if (peek() != 0xEF) return true;
+        ++m_pos;
+        return get() == 0xBB && get() == 0xBF;
+    }
+    void skipWs() {
+        for (int c = peek(); c == ' ' || c == '\t' || c == '\n' || c == '\r'; c = peek()) ++m_pos;
+    }
+    bool consume(char expected) {
+        skipWs();
+        if (peek() != expected) return false;
+        ++m_pos;
+        return true;
+    }
+
+    bool string(std::string& out) {
+        out.clear();
+        if (get() != '"') return false;
+        while (true) {
+            int c = get();
+            if (c < 0x20) return false; // EOF or raw control character
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += char(c);
+                continue;
+            }
+            switch (get()) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t cp;
+                if (!hex4(cp)) return false;
+                if (cp >= 0xD800 && cp < 0xDC00 && peek() == '\\') {
+                    ++m_pos;
+                    uint32_t lo;
+                    if (get() != 'u' || !hex4(lo)) return false;
+                    if (lo >= 0xDC00 && lo < 0xE000) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    } else {
+                        appendUtf8(out, 0xFFFD);
+                        cp = lo;
+                    }
+                }
+                if (cp >= 0xD800 && cp < 0xE000) cp = 0xFFFD; // lone surrogate
+                appendUtf8(out, cp);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+    }
+
+    bool number(double& out) {
+        m_token.clear();
+        if (peek() == '-') m_token += char(get());
+        if (!digits(true)) return false;
+        if (peek() == '.') {
+            m_token += char(get());
+            if (!digits(false)) return false;
+        }
+        if (peek() == 'e' || peek() == 'E') {
+            m_token += char(get());
+            if (peek() == '+' || peek() == '-') m_token += char(get());
+            if (!digits(false)) return false;
+        }
+        // Grammar already checked; out-of-range values still count as numbers
+        out = m_token.toDouble(); // locale independent, unlike strtod
+        return true;
+    }
+
+    bool literal(const char* word) {
+        for (const char* p = word; *p; ++p) {
+            if (get() != *p) return false;
+        }
+        return true;
+    }
+
+    // Skips one value of any type. Nesting is capped like QJsonDocument's parser.
+    bool skipValue(int depth = 0) {
+        if (depth > 1024) return false;
+        skipWs();
+        std::string scratch;
+        double d;
+        switch (peek()) {
+        case '"':
+            return string(scratch);
+        case 't':
+            return literal("true");
+        case 'f':
+            return literal("false");
+        case 'n':
+            return literal("null");
+        case '[':
+        case '{': {
+            bool object = get() == '{';
+            char close = object ? '}' : ']';
+            if (consume(close)) return true;
+            do {
+                if (object) {
+                    skipWs();
+                    if (!string(scratch) || !consume(':')) return false;
+                }
+                if (!skipValue(depth + 1)) return false;
+            } while (consume(','));
+            return consume(close);
+        }
+        default:
+            return number(d);
+        }
+    }
+
+    bool atEnd() {
+        skipWs();
+        return peek() < 0;
+    }
+
+private:
+    bool fill() {
+        m_len = m_in.read(m_buf.data(), BufferSize);
+        m_pos = 0;
+        if (m_len < 0) m_len = 0;
+        return m_len > 0;
+    }
+
+    bool hex4(uint32_t& v) {
+        v = 0;
+        for (int i = 0; i < 4; ++i) {
+            int c = get();
+            v <<= 4;
+            if (c >= '0' && c <= '9') v |= uint32_t(c - '0');
+            else if (c >= 'a' && c <= 'f') v |= uint32_t(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') v |= uint32_t(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+    bool digits(bool integerPart) {
+        int c = peek();
+        if (c < '0' || c > '9') return false;
+        if (integerPart && c == '0') {
+            m_token += char(get());
+            return true; // no leading zeros
+        }
+        while (c >= '0' && c <= '9') {
+            m_token += char(get());
+            c = peek();
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += char(cp);
+        } else if (cp < 0x800) {
+            out += char(0xC0 | (cp >> 6));
+            out += char(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += char(0xE0 | (cp >> 12));
+            out += char(0x80 | ((cp >> 6) & 0x3F));
+            out += char(0x80 | (cp & 0x3F));
+        } else {
+            out += char(0xF0 | (cp >> 18));
+            out += char(0x80 | ((cp >> 12) & 0x3F));
+            out += char(0x80 | ((cp >> 6) & 0x3F));
+            out += char(0x80 | (cp & 0x3F));
+        }
+    }
+
+    QIODevice& m_in;
+    QByteArray m_buf;
+    qint64 m_pos = 0;
+    qint64 m_len = 0;
+    QByteArray m_token;
+};
+
+// Iterates "key": value members; onMember must consume the value
+template <class F>
+bool members(Reader& r, F&& onMember) {
+    if (!r.consume('{')) return false;
+    if (r.consume('}')) return true;
+    std::string key;
+    do {
+        r.skipWs();
+        if (!r.string(key) || !r.consume(':')) return false;
+        r.skipWs();
+        if (!onMember(key)) return false;
+    } while (r.consume(','));
+    return r.consume('}');
+}
+
+// Iterates array elements; onElement must consume the value
+template <class F>
+bool elements(Reader& r, F&& onElement) {
+    if (!r.consume('[')) return false;
+    if (r.consume(']')) return true;
+    do {
+        r.skipWs();
+        if (!onElement()) return false;
+    } while (r.consume(','));
+    return r.consume(']');
+}
+
+// QJsonValue::toString/toBool/toDouble: anything of another type is skipped
+// and reads as the default
+bool stringValue(Reader& r, std::string& out) {
+    out.clear();
+    return r.peek() == '"' ? r.string(out) : r.skipValue();
+}
+
+bool boolValue(Reader& r, bool& out) {
+    out = r.peek() == 't';
+    return r.skipValue();
+}
+
+bool doubleValue(Reader& r, double& out) {
+    int c = r.peek();
+    out = 0.0;
+    return (c == '-' || (c >= '0' && c <= '9')) ? r.number(out) : r.skipValue();
+}
+
+bool parseDocument(Reader& r, DFAJsonStream::Handler& handler, QString& error) {
+    if (!r.skipBom()) {
+        error = "Invalid JSON";
+        return false;
+    }
+    r.skipWs();
+    if (r.peek() != '{') {
+        // Tell "valid JSON, wrong root" apart from garbage, like DFAJson does
+        bool valid = r.skipValue() && r.atEnd();
+        error = valid ? "JSON root must be an object" : "Invalid JSON";
+        return false;
+    }
+
+    std::string text;
+    bool ok = members(r, [&](const std::string& key) {
+        bool isArray = r.peek() == '[';
+        if (key == "alphabet" && isArray) {
+            return elements(r, [&] {
+                if (!stringValue(r, text)) return false;
+                handler.symbol(text);
+                return true;
+            });
+        }
+        if (key == "states" && isArray) {
+            return elements(r, [&] {
+                DFAState s;
+                if (r.peek() != '{') return r.skipValue() && (handler.state(s), true);
+                bool parsed = members(r, [&](const std::string& field) {
+                    if (field == "id") return stringValue(r, s.id);
+                    if (field == "start") return boolValue(r, s.isStart);
+                    if (field == "accept") return boolValue(r, s.isAccept);
+                    if (field == "x") return doubleValue(r, s.x);
+                    if (field == "y") return doubleValue(r, s.y);
+                    return r.skipValue();
+                });
+                if (parsed) handler.state(s);
+                return parsed;
+            });
+        }
+        if (key == "transitions" && isArray) {
+            return elements(r, [&] {
+                DFATransition t;
+                if (r.peek() != '{') return r.skipValue() && (handler.transition(t), true);
+                bool parsed = members(r, [&](const std::string& field) {
+                    if (field == "from") return stringValue(r, t.from);
+                    if (field == "symbol") return stringValue(r, t.symbol);
+                    if (field == "to") return stringValue(r, t.to);
+                    return r.skipValue();
+                });
+                if (parsed) handler.transition(t);
+                return parsed;
+            });
+        }
+        return r.skipValue();
+    });
+
+    if (!ok || !r.atEnd()) {
+        error = "Invalid JSON";
+        return false;
+    }
+    return true;
+}
+
+class DFAHandler : public DFAJsonStream::Handler {
+public:
+    explicit DFAHandler(DFA& dfa) : m_dfa(dfa) {}
+    void symbol(const std::string& symbol) override { m_dfa.alphabet.push_back(symbol); }
+    void state(const DFAState& s) override { m_dfa.addState(s.id, s.isStart, s.isAccept, s.x, s.y); }
+    void transition(const DFATransition& t) override { m_dfa.addTransition(t.from, t.symbol, t.to); }
+
+private:
+    DFA& m_dfa;
+};
+
+class CompactHandler : public DFAJsonStream::Handler {
+public:
+    explicit CompactHandler(CompactDFA& dfa) : m_dfa(dfa) {}
+
+    void symbol(const std::string& symbol) override { m_dfa.addSymbol(symbol); }
+
+    void state(const DFAState& s) override {
+        // Same rule as DFA::addState: a new start state replaces the old one
+        if (s.isStart && m_lastStart != CompactDFA::NONE) m_dfa.setStart(m_lastStart, false);
+        uint32_t q = m_dfa.addState(s.id, s.isStart, s.isAccept, s.x, s.y);
+        if (s.isStart) m_lastStart = q;
+    }
+
+    void transition(const DFATransition& t) override {
+        if (!place(t)) m_pending.push_back(t);
+    }
+
+    // Resolves transitions that arrived before their states or symbols
+    void finish() {
+        for (const auto& t : m_pending) {
+            if (!place(t)) m_dfa.addForeignTransition(t);
+        }
+        m_pending.clear();
+    }
+
+private:
+    bool place(const DFATransition& t) {
+        uint32_t from = m_dfa.stateIndex(t.from);
+        uint32_t a = m_dfa.symbolIndex(t.symbol);
+        uint32_t to = m_dfa.stateIndex(t.to);
+        if (from == CompactDFA::NONE || a == CompactDFA::NONE || to == CompactDFA::NONE) return false;
+        m_dfa.setTransition(from, a, to);
+        return true;
+    }
+
+    CompactDFA& m_dfa;
+    uint32_t m_lastStart = CompactDFA::NONE;
+    std::vector<DFATransition> m_pending;
+};
+
+class NFAHandler : public DFAJsonStream::Handler {
+public:
+    explicit NFAHandler(NFA& nfa) : m_nfa(nfa) {}
+
+    void symbol(const std::string& symbol) override {
+        if (!NFA::isEpsilon(symbol)) m_nfa.addSymbol(symbol);
+    }
+    // Every start flag counts: an NFA may start in several states
+    void state(const DFAState& s) override { m_nfa.addState(s.id, s.isStart, s.isAccept, s.x, s.y); }
+    void transition(const DFATransition& t) override {
+        if (!m_nfa.addTransition(t.from, t.symbol, t.to)) m_pending.push_back(t);
+    }
+    // Forward references resolve now; what still fails is dropped
+    void finish() {
+        for (const auto& t : m_pending) m_nfa.addTransition(t.from, t.symbol, t.to);
+        m_pending.clear();
+    }
+
+private:
+    NFA& m_nfa;
+    std::vector<DFATransition> m_pending;
+};
+
+// Mirrors QJsonDocument::Indented: 4-space indent, sorted keys, "}\n" at the end.
+// Compact drops the indentation and every newline, for one document per line.
+class Writer {
+public:
+    Writer(QIODevice& out, bool compact) : m_out(out), m_compact(compact) { m_buf.reserve(BufferSize); }
+
+    Writer& raw(const char* s) {
+        if (!m_compact) {
+            m_buf += s;
+            return *this;
+        }
+        for (; *s; ++s) {
+            if (*s != '\n') m_buf += *s;
+        }
+        return *this;
+    }
+    Writer& indent(int level) {
+        if (m_compact) return *this;
+        for (int i = 0; i < level; ++i) m_buf += "    ";
+        return *this;
+    }
+    Writer& str(const std::string& s) {
+        static const char hex[] = "0123456789abcdef";
+        m_buf += '"';
+        for (unsigned char c : s) {
+            switch (c) {
+            case '"': m_buf += "\\\""; break;
+            case '\\': m_buf += "\\\\"; break;
+            case '\b': m_buf += "\\b"; break;
+            case '\f': m_buf += "\\f"; break;
+            case '\n': m_buf += "\\n"; break;
+            case '\r': m_buf += "\\r"; break;
+            case '\t': m_buf += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    m_buf += "\\u00";
+                    m_buf += hex[c >> 4];
+                    m_buf += hex[c & 15];
+                } else {
+                    m_buf += char(c);
+                }
+            }
+        }
+        m_buf += '"';
+        return *this;
+    }
+    Writer& boolean(bool b) { return raw(b ? "true" : "false"); }
+    Writer& number(double d) {
+        if (!std::isfinite(d)) return raw("null");
+        // Integral values print without exponent, as QJsonDocument does
+        bool integral = std::fabs(d) < 18446744073709551616.0 && d == std::floor(d);
+        m_buf += QByteArray::number(d, integral ? 'f' : 'g', QLocale::FloatingPointShortest);
+        return *this;
+    }
+    void flushIfFull() {
+        if (m_buf.size() >= BufferSize) flush();
+    }
+    bool flush() {
+        if (!m_buf.isEmpty()) {
+            m_ok = m_ok && m_out.write(m_buf) == m_buf.size();
+            m_buf.clear();
+        }
+        return m_ok;
+    }
+
+private:
+    QIODevice& m_out;
+    QByteArray m_buf;
+    bool m_compact;
+    bool m_ok = true;
+};
+
+template <class States, class Transitions>
+bool writeDocument(QIODevice& out, bool compact, const std::vector<std::string>& alphabet, size_t numStates, States&& stateAt,
+                   size_t numTransitions, Transitions&& forEachTransition) {
+    Writer w(out, compact);
+    w.raw("{\n").indent(1).raw("\"alphabet\": [\n");
+    for (size_t i = 0; i < alphabet.size(); ++i) {
+        w.indent(2).str(alphabet[i]).raw(i + 1 < alphabet.size() ? ",\n" : "\n");
+    }
+    w.indent(1).raw("],\n").indent(1).raw("\"states\": [\n");
+    for (size_t i = 0; i < numStates; ++i) {
+        DFAState s = stateAt(i);
+        w.indent(2).raw("{\n");
+        w.indent(3).raw("\"accept\": ").boolean(s.isAccept).raw(",\n");
+        w.indent(3).raw("\"id\": ").str(s.id).raw(",\n");
+        w.indent(3).raw("\"start\": ").boolean(s.isStart).raw(",\n");
+        w.indent(3).raw("\"x\": ").number(s.x).raw(",\n");
+        w.indent(3).raw("\"y\": ").number(s.y).raw("\n");
+        w.indent(2).raw(i + 1 < numStates ? "},\n" : "}\n");
+        w.flushIfFull();
+    }
+    w.indent(1).raw("],\n").indent(1).raw("\"transitions\": [\n");
+    size_t written = 0;
+    forEachTransition([&](const std::string& from, const std::string& symbol, const std::string& to) {
+        w.indent(2).raw("{\n");
+        w.indent(3).raw("\"from\": ").str(from).raw(",\n");
+        w.indent(3).raw("\"symbol\": ").str(symbol).raw(",\n");
+        w.indent(3).raw("\"to\": ").str(to).raw("\n");
+        w.indent(2).raw(++written < numTransitions ? "},\n" : "}\n");
+        w.flushIfFull();
+    });
+    w.indent(1).raw("]\n").raw("}\n");
+    return w.flush();
+}
+
+} // namespace
+
+bool DFAJsonStream::read(QIODevice& in, Handler& handler, QString& error) {
+    Reader r(in);
+    return parseDocument(r, handler, error);
+}
+
+bool DFAJsonStream::read(QIODevice& in, DFA& dfa, QString& error) {
+    dfa.clear();
+    DFAHandler handler(dfa);
+    if (!read(in, handler, error)) {
+        dfa.clear();
+        return false;
+    }
+    return true;
+}
+
+bool DFAJsonStream::read(QIODevice& in, CompactDFA& dfa, QString& error) {
+    dfa.clear();
+    CompactHandler handler(dfa);
+    if (!read(in, handler, error)) {
+        dfa.clear();
+        return false;
+    }
+    handler.finish();
+    return true;
+}
+
+bool DFAJsonStream::read(QIODevice& in, NFA& nfa, QString& error) {
+    nfa.clear();
+    NFAHandler handler(nfa);
+    if (!read(in, handler, error)) {
+        nfa.clear();
+        return false;
+    }
+    handler.finish();
+    return true;
+}
+
+bool DFAJsonStream::write(QIODevice& out, const DFA& dfa, Format format) {
+    return writeDocument(
+        out, format == Compact, dfa.alphabet, dfa.states.size(), [&](size_t i) { return dfa.states[i]; },
+        dfa.transitions.size(), [&](auto&& emit) {
+            for (const auto& kv : dfa.transitions) emit(kv.first.first, kv.first.second, kv.second);
+        });
+}
+
+bool DFAJsonStream::write(QIODevice& out, const CompactDFA& dfa, Format format) {
+    // Duplicate state ids: only the first owns transitions, as in CompactDFA::toDFA
+    auto owns = [&](uint32_t q) { return dfa.stateIndex(dfa.stateId(q)) == q; };
+    size_t count = dfa.foreignTransitions().size();
+    for (uint32_t q = 0; q < dfa.numStates(); ++q) {
+        if (!owns(q)) continue;
+        for (uint32_t a = 0; a < dfa.numSymbols(); ++a) {
+            if (dfa.next(q, a) != CompactDFA::NONE) ++count;
+        }
+    }
+    return writeDocument(
+        out, format == Compact, dfa.symbols(), dfa.numStates(),
+        [&](size_t i) {
+            uint32_t q = uint32_t(i);
+            return DFAState{dfa.stateId(q), dfa.isStart(q), dfa.isAccept(q), dfa.x(q), dfa.y(q)};
+        },
+        count, [&](auto&& emit) {
+            for (uint32_t q = 0; q < dfa.numStates(); ++q) {
+                if (!owns(q)) continue;
+                for (uint32_t a = 0; a < dfa.numSymbols(); ++a) {
+                    uint32_t t = dfa.next(q, a);
+                    if (t != CompactDFA::NONE) emit(dfa.stateId(q), dfa.symbol(a), dfa.stateId(t));
+                }
+            }
+            for (const auto& t : dfa.foreignTransitions()) emit(t.from, t.symbol, t.to);
+        });
+}
\ No newline at end of file
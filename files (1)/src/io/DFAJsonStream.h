@@ -0,0 +1,41 @@
+#pragma once
+#include "../model/DFA.h"
+#include "../model/CompactDFA.h"
+#include "../model/NFA.h"
+#include <QIODevice>
+#include <QString>
+
+// Streaming counterpart of DFAJson for the same schema ("alphabet", "states",
+// "transitions"). The reader is a pull parser over a fixed 64 KiB window, so
+// it never holds the file or a DOM in memory; the writer emits the same
+// indented layout as QJsonDocument as it walks the automaton.
+// Every document DFAJson::fromJson accepts is accepted here, with the same
+// lenient conversions (wrong-typed values read as "", false or 0).
+class DFAJsonStream {
+public:
+    // Receives the elements in file order
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+        virtual void symbol(const std::string& symbol) = 0;
+        virtual void state(const DFAState& state) = 0;
+        virtual void transition(const DFATransition& transition) = 0;
+    };
+
+    static bool read(QIODevice& in, Handler& handler, QString& error);
+    static bool read(QIODevice& in, DFA& dfa, QString& error);
+    // Transitions that name states or symbols not seen yet are held back until
+    // the end of the document; with states before transitions (the order
+    // write() uses) the compact table is filled in a single pass.
+    static bool read(QIODevice& in, CompactDFA& dfa, QString& error);
+    // Same schema read as an NFA: repeated (from, symbol) pairs all count,
+    // every start flag counts, and the symbols "" and "ε" are ε-transitions
+    static bool read(QIODevice& in, NFA& nfa, QString& error);
+
+    enum Format {
+        Indented, // QJsonDocument::Indented layout
+        Compact   // no indentation or newlines: one line per document
+    };
+    static bool write(QIODevice& out, const DFA& dfa, Format format = Indented);
+    static bool write(QIODevice& out, const CompactDFA& dfa, Format format = Indented);
+};
\ No newline at end of file
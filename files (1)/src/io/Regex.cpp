@@ -0,0 +1,575 @@
+#include "Regex.h"
+#include "../algorithms/SubsetConstruction.h"
+#include <QFile>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint32_t NONE = NFA::NONE;
+constexpr uint32_t Unbounded = NONE;
+constexpr uint32_t MaxRepeat = 1000; // largest bound in {m,n}
+constexpr uint32_t MaxRange = 4096;  // characters in one class range
+constexpr int MaxDepth = 1000;       // nested groups
+
+struct Node {
+    enum Kind { Empty, Class, Concat, Alternation, Repeat };
+    Kind kind = Empty;
+    std::vector<uint32_t> children;
+    std::vector<uint32_t> symbols; // Class: alphabet indices, complemented when negated
+    bool negated = false;
+    uint32_t min = 0, max = 0; // Repeat
+};
+
+size_t charLength(unsigned char c) {
+    if (c >= 0xF0 && c < 0xF8) return 4;
+    if (c >= 0xE0 && c < 0xF0) return 3;
+    if (c >= 0xC0 && c < 0xE0) return 2;
+    return 1; // ASCII, or a stray byte taken on its own
+}
+
+uint32_t decode(const std::string& ch) {
+    static const unsigned char leadMask[] = {0, 0x7F, 0x1F, 0x0F, 0x07};
+    uint32_t cp = uint32_t(ch[0]) & leadMask[ch.size()];
+    for (size_t i = 1; i < ch.size(); ++i) cp = (cp << 6) | (uint32_t(ch[i]) & 0x3F);
+    return cp;
+}
+
+std::string encode(uint32_t cp) {
+    std::string out;
+    if (cp < 0x80) {
+        out += char(cp);
+    } else if (cp < 0x800) {
+        out += char(0xC0 | (cp >> 6));
+        out += char(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += char(0xE0 | (cp >> 12));
+        out += char(0x80 | ((cp >> 6) & 0x3F));
+        out += char(0x80 | (cp & 0x3F));
+    } else {
+        out += char(0xF0 | (cp >> 18));
+        out += char(0x80 | ((cp >> 12) & 0x3F));
+        out += char(0x80 | ((cp >> 6) & 0x3F));
+        out += char(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+// Recursive descent over one pattern; symbols go straight into the NFA's alphabet
+class Parser {
+public:
+    Parser(const std::string& text, NFA& nfa, std::vector<Node>& nodes) : m_text(text), m_nfa(nfa), m_nodes(nodes) {}
+
+    // Root node, or NONE with error() and column() set
+    uint32_t parse() {
+        m_end = m_text.size();
+        if (at('^')) ++m_pos;
+        if (m_end > m_pos && m_text[m_end - 1] == '$' && !escaped(m_end - 1)) --m_end;
+        uint32_t root = alternation();
+        if (root != NONE && m_pos < m_end) return fail(at(')') ? "unbalanced ')'" : "unexpected character");
+        return root;
+    }
+
+    const std::string& error() const { return m_error; }
+    size_t column() const { return m_pos + 1; }
+
+private:
+    bool at(char c) const { return m_pos < m_end && m_text[m_pos] == c; }
+
+    bool escaped(size_t i) const {
+        size_t backslashes = 0;
+        while (i > backslashes && m_text[i - 1 - backslashes] == '\\') ++backslashes;
+        return backslashes % 2 == 1;
+    }
+
+    uint32_t fail(const char* message) {
+        if (m_error.empty()) m_error = message;
+        return NONE;
+    }
+
+    bool reject(const char* message) {
+        fail(message);
+        return false;
+    }
+
+    uint32_t add(Node::Kind kind) {
+        m_nodes.emplace_back();
+        m_nodes.back().kind = kind;
+        return uint32_t(m_nodes.size() - 1);
+    }
+
+    uint32_t alternation() {
+        uint32_t first = concatenation();
+        if (first == NONE || !at('|')) return first;
+        uint32_t alt = add(Node::Alternation);
+        m_nodes[alt].children.push_back(first);
+        while (at('|')) {
+            ++m_pos;
+            uint32_t next = concatenation();
+            if (next == NONE) return NONE;
+            m_nodes[alt].children.push_back(next);
+        }
+        return alt;
+    }
+
+    uint32_t concatenation() {
+        std::vector<uint32_t> parts;
+        while (m_pos < m_end && !at('|') && !at(')')) {
+            uint32_t part = repetition();
+            if (part == NONE) return NONE;
+            parts.push_back(part);
+        }
+        if (parts.empty()) return add(Node::Empty);
+        if (parts.size() == 1) return parts[0];
+        uint32_t concat = add(Node::Concat);
+        m_nodes[concat].children = std::move(parts);
+        return concat;
+    }
+
+    uint32_t repetition() {
+        uint32_t node = atom();
+        while (node != NONE && m_pos < m_end) {
+            uint32_t min = 0, max = Unbounded;
+            if (at('*')) {
+                ++m_pos;
+            } else if (at('+')) {
+                min = 1;
+                ++m_pos;
+            } else if (at('?')) {
+                max = 1;
+                ++m_pos;
+            } else if (!at('{') || !bounds(min, max)) {
+                break;
+            }
+            if (!m_error.empty()) return NONE;
+            uint32_t repeat = add(Node::Repeat);
+            m_nodes[repeat].children.push_back(node);
+            m_nodes[repeat].min = min;
+            m_nodes[repeat].max = max;
+            node = repeat;
+        }
+        return node;
+    }
+
+    // {m}, {m,} or {m,n}; false, with nothing consumed, when it is not one
+    bool bounds(uint32_t& min, uint32_t& max) {
+        size_t i = m_pos + 1;
+        auto number = [&](uint32_t& v) {
+            size_t start = i;
+            uint64_t value = 0;
+            while (i < m_end && m_text[i] >= '0' && m_text[i] <= '9' && value <= MaxRepeat) value = value * 10 + uint32_t(m_text[i++] - '0');
+            v = uint32_t(std::min<uint64_t>(value, MaxRepeat + 1));
+            return i > start;
+        };
+        if (!number(min)) return false;
+        max = min;
+        if (i < m_end && m_text[i] == ',') {
+            ++i;
+            if (!number(max)) max = Unbounded;
+        }
+        if (i >= m_end || m_text[i] != '}') return false;
+        m_pos = i + 1;
+        if (min > MaxRepeat || (max != Unbounded && max > MaxRepeat)) fail("repeat count too large");
+        else if (max < min) fail("repeat bounds out of order");
+        return true;
+    }
+
+    uint32_t atom() {
+        if (at('(')) {
+            if (++m_depth > MaxDepth) return fail("groups nested too deeply");
+            ++m_pos;
+            if (m_text.compare(m_pos, 2, "?:") == 0) m_pos += 2;
+            uint32_t inner = alternation();
+            if (inner == NONE) return NONE;
+            if (!at(')')) return fail("missing ')'");
+            ++m_pos;
+            --m_depth;
+            return inner;
+        }
+        if (at('*') || at('+') || at('?')) return fail("nothing to repeat");
+        uint32_t node = add(Node::Class);
+        if (at('[')) {
+            ++m_pos;
+            return charClass(node) ? node : NONE;
+        }
+        if (at('.')) {
+            ++m_pos;
+            m_nodes[node].negated = true;
+            return node;
+        }
+        std::string ch;
+        if (!character(node, ch)) return NONE;
+        if (!ch.empty()) symbol(node, ch);
+        return node;
+    }
+
+    // [...] after the '['; ']' right after the '[' or '[^' is a literal
+    bool charClass(uint32_t node) {
+        if (at('^')) {
+            m_nodes[node].negated = true;
+            ++m_pos;
+        }
+        bool first = true;
+        while (m_pos < m_end && (first || !at(']'))) {
+            first = false;
+            std::string lo;
+            if (!character(node, lo)) return false;
+            if (lo.empty()) continue; // \d, \w or \s, already added
+            if (!at('-') || m_pos + 1 >= m_end || m_text[m_pos + 1] == ']') {
+                symbol(node, lo);
+                continue;
+            }
+            ++m_pos;
+            std::string hi;
+            if (!character(node, hi)) return false;
+            if (hi.empty()) return reject("class escape cannot end a range");
+            uint32_t from = decode(lo), to = decode(hi);
+            if (to < from) return reject("range out of order");
+            if (to - from >= MaxRange) return reject("range too large");
+            for (uint32_t cp = from; cp <= to; ++cp) symbol(node, encode(cp));
+        }
+        if (!at(']')) return reject("missing ']'");
+        ++m_pos;
+        return true;
+    }
+
+    // One literal character or escape into ch; the classes \d, \w and \s go
+    // straight into node and leave ch empty
+    bool character(uint32_t node, std::string& ch) {
+        ch.clear();
+        if (!at('\\')) {
+            size_t n = std::min(charLength(static_cast<unsigned char>(m_text[m_pos])), m_end - m_pos);
+            ch = m_text.substr(m_pos, n);
+            m_pos += n;
+            return true;
+        }
+        if (++m_pos >= m_end) return reject("trailing '\\'");
+        switch (m_text[m_pos]) {
+        case 'n': ch = "\n"; break;
+        case 't': ch = "\t"; break;
+        case 'r': ch = "\r"; break;
+        case 'f': ch = "\f"; break;
+        case 'v': ch = "\v"; break;
+        case 'd': range(node, '0', '9'); break;
+        case 'w':
+            range(node, 'a', 'z');
+            range(node, 'A', 'Z');
+            range(node, '0', '9');
+            symbol(node, "_");
+            break;
+        case 's':
+            for (const char* s : {" ", "\t", "\n", "\r", "\f", "\v"}) symbol(node, s);
+            break;
+        default: {
+            size_t n = std::min(charLength(static_cast<unsigned char>(m_text[m_pos])), m_end - m_pos);
+            ch = m_text.substr(m_pos, n);
+            m_pos += n;
+            return true;
+        }
+        }
+        ++m_pos;
+        return true;
+    }
+
+    void symbol(uint32_t node, const std::string& ch) { m_nodes[node].symbols.push_back(m_nfa.addSymbol(ch)); }
+    void range(uint32_t node, char from, char to) {
+        for (char c = from; c <= to; ++c) symbol(node, std::string(1, c));
+    }
+
+    const std::string& m_text;
+    NFA& m_nfa;
+    std::vector<Node>& m_nodes;
+    size_t m_pos = 0;
+    size_t m_end = 0;
+    int m_depth = 0;
+    std::string m_error;
+};
+
+// Shares the common leading terms of the alternated patterns, trie-like:
+// ".*foo|.*bar|abc|abd" becomes ".*(foo|bar)|ab(c|d)". Glushkov gives every
+// occurrence its own position, so without this each of a thousand ".*rule"
+// patterns keeps its own ".*" position alive in every subset.
+class Factorer {
+public:
+    explicit Factorer(std::vector<Node>& nodes) : m_nodes(nodes), m_keys(nodes.size()) {}
+
+    uint32_t factor(const std::vector<uint32_t>& roots) {
+        // Each top-level branch is one sequence of terms
+        for (uint32_t root : roots) {
+            const Node& node = m_nodes[root];
+            if (node.kind == Node::Alternation) {
+                for (uint32_t c : node.children) m_sequences.push_back(terms(c));
+            } else {
+                m_sequences.push_back(terms(root));
+            }
+        }
+        std::vector<std::pair<uint32_t, uint32_t>> items;
+        for (uint32_t s = 0; s < m_sequences.size(); ++s) items.emplace_back(s, 0);
+        return factor(items);
+    }
+
+private:
+    std::vector<uint32_t> terms(uint32_t n) const {
+        if (m_nodes[n].kind == Node::Concat) return m_nodes[n].children;
+        if (m_nodes[n].kind == Node::Empty) return {};
+        return {n};
+    }
+
+    // Alternation of the sequence suffixes in items (sequence, offset)
+    uint32_t factor(const std::vector<std::pair<uint32_t, uint32_t>>& items) {
+        std::vector<std::vector<std::pair<uint32_t, uint32_t>>> groups;
+        std::unordered_map<std::string, size_t> groupOf;
+        bool empty = false;
+        for (const auto& item : items) {
+            const std::vector<uint32_t>& seq = m_sequences[item.first];
+            if (item.second == seq.size()) {
+                empty = true;
+                continue;
+            }
+            auto it = groupOf.emplace(key(seq[item.second]), groups.size()).first;
+            if (it->second == groups.size()) groups.emplace_back();
+            groups[it->second].emplace_back(item.first, item.second + 1);
+        }
+
+        std::vector<uint32_t> branches;
+        for (const auto& group : groups) {
+            const std::vector<uint32_t>& seq = m_sequences[group[0].first];
+            uint32_t head = seq[group[0].second - 1];
+            if (group.size() == 1 && group[0].second == seq.size()) {
+                branches.push_back(head);
+                continue;
+            }
+            uint32_t rest = NONE;
+            if (group.size() == 1) {
+                rest = add(Node::Concat);
+                m_nodes[rest].children.assign(seq.begin() + group[0].second, seq.end());
+            } else {
+                rest = factor(group);
+            }
+            uint32_t concat = add(Node::Concat);
+            m_nodes[concat].children = {head, rest};
+            branches.push_back(concat);
+        }
+        if (empty) branches.push_back(add(Node::Empty));
+        if (branches.size() == 1) return branches[0];
+        uint32_t alt = add(Node::Alternation);
+        m_nodes[alt].children = std::move(branches);
+        return alt;
+    }
+
+    // Equal keys mean structurally equal subexpressions
+    const std::string& key(uint32_t n) {
+        if (!m_keys[n].empty()) return m_keys[n];
+        const Node& node = m_nodes[n];
+        std::string k(1, char('0' + node.kind));
+        if (node.kind == Node::Class) {
+            std::vector<uint32_t> symbols = node.symbols;
+            std::sort(symbols.begin(), symbols.end());
+            symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+            k += node.negated ? "^" : "";
+            for (uint32_t a : symbols) k += std::to_string(a) + ",";
+        } else if (node.kind == Node::Repeat) {
+            k += std::to_string(node.min) + "," + std::to_string(node.max);
+        }
+        k += "(";
+        for (uint32_t c : node.children) k += key(c) + ";";
+        m_keys[n] = k + ")";
+        return m_keys[n];
+    }
+
+    uint32_t add(Node::Kind kind) {
+        m_nodes.emplace_back();
+        m_nodes.back().kind = kind;
+        return uint32_t(m_nodes.size() - 1);
+    }
+
+    std::vector<Node>& m_nodes;
+    std::vector<std::string> m_keys; // only for the parsed nodes; new ones are never keyed
+    std::vector<std::vector<uint32_t>> m_sequences;
+};
+
+// first, last and nullable of a subexpression, over NFA positions
+struct Fragment {
+    bool nullable = true;
+    std::vector<uint32_t> first;
+    std::vector<uint32_t> last;
+};
+
+// Glushkov's construction: every Class node visited becomes a fresh
+// position, so a bounded repeat visits its operand once per copy. Nested
+// bounds multiply, so positions and follow edges are counted against a limit.
+class Builder {
+public:
+    Builder(NFA& nfa, const std::vector<Node>& nodes, uint64_t limit)
+        : m_nfa(nfa), m_nodes(nodes), m_resolved(nodes.size()), m_limit(limit ? limit : UINT64_MAX) {
+        // Classes resolve against the finished alphabet
+        for (size_t n = 0; n < nodes.size(); ++n) {
+            if (nodes[n].kind != Node::Class) continue;
+            std::vector<uint32_t> symbols = nodes[n].symbols;
+            std::sort(symbols.begin(), symbols.end());
+            symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+            if (nodes[n].negated) {
+                std::vector<uint32_t> rest;
+                for (uint32_t a = 0; a < nfa.numSymbols(); ++a) {
+                    if (!std::binary_search(symbols.begin(), symbols.end(), a)) rest.push_back(a);
+                }
+                symbols.swap(rest);
+            }
+            m_resolved[n] = std::move(symbols);
+        }
+    }
+
+    // False, with the NFA incomplete, once the limit is passed
+    bool build(uint32_t root) {
+        uint32_t initial = m_nfa.addState("0", true, false);
+        m_classOf.push_back(NONE);
+        Fragment f = visit(root);
+        follow({initial}, f.first);
+        if (m_size > m_limit) return false;
+        m_nfa.setAccept(initial, f.nullable);
+        for (uint32_t p : f.last) m_nfa.setAccept(p, true);
+        return true;
+    }
+
+private:
+    Fragment visit(uint32_t n) {
+        const Node& node = m_nodes[n];
+        Fragment f;
+        if (m_size > m_limit) return f;
+        switch (node.kind) {
+        case Node::Empty:
+            break;
+        case Node::Class: {
+            uint32_t p = m_nfa.addState(std::to_string(m_nfa.numStates()), false, false);
+            m_classOf.push_back(n);
+            ++m_size;
+            f.nullable = false;
+            f.first.push_back(p);
+            f.last.push_back(p);
+            break;
+        }
+        case Node::Concat:
+            for (uint32_t c : node.children) f = concat(std::move(f), visit(c));
+            break;
+        case Node::Alternation:
+            f.nullable = false;
+            for (uint32_t c : node.children) {
+                Fragment g = visit(c);
+                f.nullable = f.nullable || g.nullable;
+                f.first.insert(f.first.end(), g.first.begin(), g.first.end());
+                f.last.insert(f.last.end(), g.last.begin(), g.last.end());
+            }
+            break;
+        case Node::Repeat: {
+            const uint32_t child = node.children[0];
+            // e{m,} = e…e e+ and e{0,} = e*; e{m,n} = e…e e?…e?
+            for (uint32_t i = 0; i < node.min; ++i) {
+                Fragment g = visit(child);
+                if (node.max == Unbounded && i + 1 == node.min) follow(g.last, g.first);
+                f = concat(std::move(f), std::move(g));
+            }
+            if (node.max == Unbounded && node.min == 0) {
+                Fragment g = visit(child);
+                follow(g.last, g.first);
+                g.nullable = true;
+                f = concat(std::move(f), std::move(g));
+            }
+            for (uint32_t i = node.min; node.max != Unbounded && i < node.max; ++i) {
+                Fragment g = visit(child);
+                g.nullable = true;
+                f = concat(std::move(f), std::move(g));
+            }
+            break;
+        }
+        }
+        return f;
+    }
+
+    Fragment concat(Fragment a, Fragment b) {
+        follow(a.last, b.first);
+        if (a.nullable) a.first.insert(a.first.end(), b.first.begin(), b.first.end());
+        if (b.nullable) b.last.insert(b.last.end(), a.last.begin(), a.last.end());
+        a.last = std::move(b.last);
+        a.nullable = a.nullable && b.nullable;
+        return a;
+    }
+
+    // p -> q on every symbol of q's class, for p in from and q in to
+    void follow(const std::vector<uint32_t>& from, const std::vector<uint32_t>& to) {
+        for (uint32_t p : from) {
+            for (uint32_t q : to) {
+                if ((m_size += m_resolved[m_classOf[q]].size()) > m_limit) return;
+                for (uint32_t a : m_resolved[m_classOf[q]]) m_nfa.addTransition(p, a, q);
+            }
+        }
+    }
+
+    NFA& m_nfa;
+    const std::vector<Node>& m_nodes;
+    std::vector<std::vector<uint32_t>> m_resolved; // per Class node
+    std::vector<uint32_t> m_classOf;               // per NFA state
+    uint64_t m_limit;
+    uint64_t m_size = 0;                           // positions plus edges so far
+};
+
+} // namespace
+
+bool Regex::toNFA(const std::vector<std::string>& patterns, NFA& nfa, QString& error, const RegexOptions& options) {
+    nfa.clear();
+    for (const auto& sym : options.alphabet) nfa.addSymbol(sym);
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> roots;
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        Parser parser(patterns[i], nfa, nodes);
+        uint32_t root = parser.parse();
+        if (root == NONE) {
+            QString where = QString("column %1").arg(unsigned(parser.column()));
+            if (patterns.size() > 1) where = QString("pattern %1, ").arg(unsigned(i + 1)) + where;
+            error = where + ": " + QString::fromStdString(parser.error());
+            nfa.clear();
+            return false;
+        }
+        roots.push_back(root);
+    }
+
+    // No patterns: the empty language, an alternation with no branches
+    uint32_t root = Factorer(nodes).factor(roots);
+    if (!Builder(nfa, nodes, options.maxNFASize).build(root)) {
+        error = QString("The patterns need more than %1 NFA positions and edges").arg(quint64(options.maxNFASize));
+        nfa.clear();
+        return false;
+    }
+    return true;
+}
+
+bool Regex::compile(const std::vector<std::string>& patterns, CompactDFA& dfa, QString& error, const RegexOptions& options) {
+    NFA nfa;
+    if (!toNFA(patterns, nfa, error, options)) return false;
+    if (!SubsetConstruction::determinize(nfa, dfa, options.maxStates)) {
+        error = QString("The automaton needs more than %1 states").arg(options.maxStates);
+        dfa.clear();
+        return false;
+    }
+    return true;
+}
+
+bool Regex::read(QIODevice& in, CompactDFA& dfa, QString& error, const RegexOptions& options) {
+    std::vector<std::string> patterns;
+    while (!in.atEnd()) {
+        std::string line = in.readLine().toStdString();
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
+        if (!line.empty()) patterns.push_back(std::move(line));
+    }
+    return compile(patterns, dfa, error, options);
+}
+
+bool Regex::load(const QString& path, CompactDFA& dfa, QString& error, const RegexOptions& options) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        error = f.errorString();
+        return false;
+    }
+    return read(f, dfa, error, options);
+}
\ No newline at end of file
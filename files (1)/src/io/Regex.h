@@ -0,0 +1,41 @@
+#pragma once
+#include "../model/CompactDFA.h"
+#include "../model/NFA.h"
+#include <QIODevice>
+#include <QString>
+#include <string>
+#include <vector>
+
+struct RegexOptions {
+    // Symbols "." and negated classes range over, ahead of the ones the
+    // patterns mention; without them they range over the mentioned ones only
+    std::vector<std::string> alphabet;
+    uint32_t maxStates = 0; // subset construction limit; 0 = none
+    // Glushkov NFA limit, positions plus edges; nested bounds such as
+    // (a{0,1000}){0,1000} multiply. 0 = none
+    uint64_t maxNFASize = 20000000;
+};
+
+// Regular expressions to automata. One symbol is one UTF-8 character, and a
+// pattern matches whole words (a leading "^" and trailing "$" are accepted
+// and ignored). Syntax: literals, "\" escapes (\n \t \r \d \w \s, anything
+// else literal), ".", classes with ranges and "^" negation, groups "(…)" and
+// "(?:…)", "|", and the quantifiers * + ? {m} {m,} {m,n}. A "{" that does not
+// start a valid quantifier is a literal.
+//
+// The construction is Glushkov's: one NFA state per symbol occurrence plus an
+// initial state, no ε-transitions, and an edge p -> q on a whenever q is an
+// occurrence of a that may follow p. Many patterns are compiled as one
+// alternation, so thousands of rules share a single subset construction.
+class Regex {
+public:
+    static bool toNFA(const std::vector<std::string>& patterns, NFA& nfa, QString& error, const RegexOptions& options = {});
+
+    // toNFA and SubsetConstruction: a partial DFA ready for any minimizer
+    static bool compile(const std::vector<std::string>& patterns, CompactDFA& dfa, QString& error,
+                        const RegexOptions& options = {});
+
+    // One pattern per line (\n or \r\n); empty lines are skipped
+    static bool read(QIODevice& in, CompactDFA& dfa, QString& error, const RegexOptions& options = {});
+    static bool load(const QString& path, CompactDFA& dfa, QString& error, const RegexOptions& options = {});
+};
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+// View scales below which the graph drops detail. Arrowheads and labels are
+// unreadable long before the edges themselves, and at the lowest zoom every
+// transition is drawn as part of one shared path instead of its own item.
+struct LevelOfDetail {
+    static constexpr double Labels = 0.6;   // state ids, transition symbols
+    static constexpr double Arrows = 0.4;   // arrowheads, accept rings, start markers
+    static constexpr double Batched = 0.25; // transitions merged into one path
+};
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include "StateItem.h"
+#include "../GraphScene.h"
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
 #include <QFont>
+#include "LevelOfDetail.h"
 
 const double RADIUS = 25.0;
 
@@ -14,6 +16,8 @@ StateItem::StateItem(const QString& id, double x, double y, bool isStart, bool i
     setBrush(Qt::white);
     setPen(QPen(Qt::black, 2));
     setZValue(1);
+    // States look identical at a given zoom, so repaints blit a cached pixmap
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 }
 
 void StateItem::setId(const QString& id) {
@@ -42,6 +46,10 @@ void StateItem::clearHighlight() {
     update();
 }
 
+QRectF StateItem::boundingRect() const {
+    return rect().adjusted(-14, -5, 5, 5);
+}
+
 void StateItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
     Q_UNUSED(widget);
     
@@ -49,7 +57,7 @@ void StateItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     if (option->state & QStyle::State_Selected) {
         painter->setBrush(Qt::NoBrush);
         painter->setPen(QPen(Qt::blue, 2, Qt::DashLine));
-        painter->drawEllipse(boundingRect().adjusted(-2,-2,2,2));
+        painter->drawEllipse(rect().adjusted(-3,-3,3,3));
     }
 
     // Fill
@@ -57,6 +65,9 @@ void StateItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     painter->setPen(QPen(Qt::black, 2));
     painter->drawEllipse(rect());
     
+    const qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    if (lod < LevelOfDetail::Arrows) return;
+    
     // Double circle for accept
     if (m_isAccept) {
         painter->drawEllipse(rect().adjusted(4,4,-4,-4));
@@ -71,17 +82,17 @@ void StateItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     }
     
     // Text
+    if (lod < LevelOfDetail::Labels) return;
+    static const QFont idFont("Arial", 10, QFont::Bold);
     painter->setPen(Qt::black);
-    painter->setFont(QFont("Arial", 10, QFont::Bold));
+    painter->setFont(idFont);
     painter->drawText(rect(), Qt::AlignCenter, m_id);
 }
 
 QVariant StateItem::itemChange(GraphicsItemChange change, const QVariant &value) {
-    if (change == ItemPositionHasChanged && scene()) {
-        // Notify scene or transitions to update
-        // We handle this in scene/transition logic usually, 
-        // but QGraphicsScene detects this via signals if we hook them up,
-        // or transitions can track nodes.
+    if (change == ItemPositionHasChanged) {
+        // Only the transitions touching this state need to follow it
+        if (auto* graph = qobject_cast<GraphScene*>(scene())) graph->stateMoved(this);
     }
     return QGraphicsEllipseItem::itemChange(change, value);
 }
\ No newline at end of file
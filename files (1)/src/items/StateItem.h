@@ -6,6 +6,9 @@
 
 class StateItem : public QGraphicsEllipseItem {
 public:
+    enum { Type = UserType + 1 };
+    int type() const override { return Type; }
+
     StateItem(const QString& id, double x, double y, bool isStart, bool isAccept);
     
     void setId(const QString& id);
@@ -20,6 +23,9 @@ public:
     // Highlighting
     void setHighlight(const QColor& color);
     void clearHighlight();
+
+    // Circle plus start marker and selection outline; the item cache clips to it
+    QRectF boundingRect() const override;
     
 protected:
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
@@ -1,6 +1,8 @@
 #include "TransitionItem.h"
 #include <QPainter>
 #include <QtMath>
+#include <QStyleOptionGraphicsItem>
+#include "LevelOfDetail.h"
 
 TransitionItem::TransitionItem(StateItem* from, StateItem* to, const QString& symbol)
     : m_from(from), m_to(to), m_symbol(symbol)
@@ -61,41 +63,46 @@ void TransitionItem::updatePosition() {
         }
     }
     
+    // Arrowhead from the direction at the end of the path
+    QPointF endPoint = path.pointAtPercent(1.0);
+    QPointF preEndPoint = path.pointAtPercent(m_from == m_to ? 0.90 : 0.95);
+    QLineF tip(preEndPoint, endPoint);
+    double angle = std::atan2(-tip.dy(), tip.dx());
+    QPointF arrowP1 = endPoint - QPointF(sin(angle + M_PI / 3) * 10, cos(angle + M_PI / 3) * 10);
+    QPointF arrowP2 = endPoint - QPointF(sin(angle + M_PI - M_PI / 3) * 10, cos(angle + M_PI - M_PI / 3) * 10);
+    m_arrow = QPolygonF() << endPoint << arrowP1 << arrowP2;
+    
+    // Label centred on the midpoint, or above a self loop
+    QPointF mid = m_from == m_to ? QPointF(p1.x(), p1.y() - 75) : (p1 + p2) / 2;
+    m_labelRect = QRectF(mid.x() - 20, mid.y() - 10, 40, 20);
+    
+    prepareGeometryChange();
     setPath(path);
+    m_bounds = path.boundingRect().united(m_arrow.boundingRect()).united(m_labelRect).adjusted(-2, -2, 2, 2);
+}
+
+QRectF TransitionItem::boundingRect() const {
+    return m_bounds;
 }
 
 void TransitionItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
     Q_UNUSED(option);
     Q_UNUSED(widget);
     
-    painter->setPen(QPen(m_highlighted ? m_highlightColor : Qt::black, 2));
-    painter->drawPath(path());
-    
-    // Draw arrow head
-    QPainterPath p = path();
-    if (p.elementCount() < 2) return;
-    
-    QPointF endPoint = p.pointAtPercent(1.0);
-    // Approximate angle
-    QPointF preEndPoint = p.pointAtPercent(0.95); // rough approximation
-    if (m_from == m_to) preEndPoint = p.pointAtPercent(0.90);
+    const qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    const QColor color = m_highlighted ? m_highlightColor : QColor(Qt::black);
     
-    QLineF line(preEndPoint, endPoint);
-    double angle = std::atan2(-line.dy(), line.dx());
-
-    QPointF arrowP1 = endPoint - QPointF(sin(angle + M_PI / 3) * 10, cos(angle + M_PI / 3) * 10);
-    QPointF arrowP2 = endPoint - QPointF(sin(angle + M_PI - M_PI / 3) * 10, cos(angle + M_PI - M_PI / 3) * 10);
-
-    painter->setBrush(m_highlighted ? m_highlightColor : Qt::black);
-    painter->drawPolygon(QPolygonF() << endPoint << arrowP1 << arrowP2);
+    painter->setPen(QPen(color, 2));
+    painter->setBrush(Qt::NoBrush);
+    painter->drawPath(path());
+    if (lod < LevelOfDetail::Arrows || m_arrow.isEmpty()) return;
     
-    // Draw Text
-    // Find midpoint
-    QPointF mid;
-    if (m_from == m_to) mid = QPointF(m_from->x(), m_from->y() - 75);
-    else mid = (m_from->pos() + m_to->pos()) / 2;
+    painter->setBrush(color);
+    painter->drawPolygon(m_arrow);
+    if (lod < LevelOfDetail::Labels) return;
     
+    static const QFont labelFont("Arial", 9);
     painter->setPen(Qt::blue);
-    painter->setFont(QFont("Arial", 9));
-    painter->drawText(QRectF(mid.x()-20, mid.y()-10, 40, 20), Qt::AlignCenter, m_symbol);
+    painter->setFont(labelFont);
+    painter->drawText(m_labelRect, Qt::AlignCenter, m_symbol);
 }
\ No newline at end of file
@@ -4,6 +4,9 @@
 
 class TransitionItem : public QGraphicsPathItem {
 public:
+    enum { Type = UserType + 2 };
+    int type() const override { return Type; }
+
     TransitionItem(StateItem* from, StateItem* to, const QString& symbol);
     
     void updatePosition();
@@ -16,6 +19,9 @@ public:
     void setHighlight(const QColor& color);
     void clearHighlight();
 
+    // Path plus arrowhead and label, as cached by updatePosition()
+    QRectF boundingRect() const override;
+
 protected:
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
 
@@ -25,4 +31,8 @@ private:
     QString m_symbol;
     bool m_highlighted = false;
     QColor m_highlightColor;
+    // Geometry derived from the endpoints, so paint() only draws
+    QPolygonF m_arrow;
+    QRectF m_labelRect;
+    QRectF m_bounds;
 };
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "ForceLayout.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+// Square cell of the quadtree; a leaf holds one state, or several when the
+// cell is too small to split further
+struct QuadNode {
+    double x0, y0, size;
+    double mx = 0, my = 0; // centre of mass once built, position sum until then
+    uint32_t mass = 0;
+    uint32_t child = CompactDFA::NONE; // first of four, in quadrant order
+    uint32_t point = CompactDFA::NONE;
+};
+
+class QuadTree {
+public:
+    void build(const std::vector<double>& x, const std::vector<double>& y, double minSize) {
+        double minX = *std::min_element(x.begin(), x.end()), maxX = *std::max_element(x.begin(), x.end());
+        double minY = *std::min_element(y.begin(), y.end()), maxY = *std::max_element(y.begin(), y.end());
+        m_nodes.clear();
+        m_nodes.push_back({minX, minY, std::max({maxX - minX, maxY - minY, minSize})});
+        for (uint32_t q = 0; q < x.size(); ++q) insert(q, x, y, minSize);
+        for (auto& node : m_nodes) {
+            if (node.mass == 0) continue;
+            node.mx /= node.mass;
+            node.my /= node.mass;
+        }
+    }
+
+    // Adds the repulsion k²·mass/d from every group, pointing away from it
+    void repulsion(double x, double y, double k2, double& fx, double& fy, std::vector<uint32_t>& stack) const {
+        const double theta2 = ForceLayout::Theta * ForceLayout::Theta;
+        stack.clear();
+        stack.push_back(0);
+        while (!stack.empty()) {
+            const QuadNode& node = m_nodes[stack.back()];
+            stack.pop_back();
+            if (node.mass == 0) continue;
+            double dx = x - node.mx, dy = y - node.my;
+            double d2 = dx * dx + dy * dy;
+            if (node.child == CompactDFA::NONE || node.size * node.size < theta2 * d2) {
+                if (d2 < 1e-9) continue; // the state itself, or one on the same spot
+                double f = k2 * node.mass / d2;
+                fx += dx * f;
+                fy += dy * f;
+            } else {
+                for (uint32_t c = 0; c < 4; ++c) stack.push_back(node.child + c);
+            }
+        }
+    }
+
+private:
+    void insert(uint32_t q, const std::vector<double>& x, const std::vector<double>& y, double minSize) {
+        uint32_t i = 0;
+        while (true) {
+            if (m_nodes[i].child == CompactDFA::NONE) {
+                // Empty leaf, or one too small to split: the state stays here
+                if (m_nodes[i].mass == 0 || m_nodes[i].size < minSize) {
+                    add(i, q, x[q], y[q]);
+                    return;
+                }
+                // Occupied leaf: split it and move its state one level down
+                uint32_t resident = m_nodes[i].point;
+                split(i);
+                add(quadrant(i, x[resident], y[resident]), resident, x[resident], y[resident]);
+            }
+            add(i, q, x[q], y[q]);
+            i = quadrant(i, x[q], y[q]);
+        }
+    }
+
+    void add(uint32_t i, uint32_t q, double x, double y) {
+        QuadNode& node = m_nodes[i];
+        if (node.child == CompactDFA::NONE && node.mass == 0) node.point = q;
+        node.mass += 1;
+        node.mx += x;
+        node.my += y;
+    }
+
+    void split(uint32_t i) {
+        uint32_t first = uint32_t(m_nodes.size());
+        double half = m_nodes[i].size / 2;
+        for (uint32_t c = 0; c < 4; ++c) {
+            m_nodes.push_back({m_nodes[i].x0 + (c & 1) * half, m_nodes[i].y0 + (c >> 1) * half, half});
+        }
+        m_nodes[i].child = first;
+        m_nodes[i].point = CompactDFA::NONE;
+    }
+
+    uint32_t quadrant(uint32_t i, double x, double y) const {
+        const QuadNode& node = m_nodes[i];
+        double half = node.size / 2;
+        return node.child + (x >= node.x0 + half ? 1 : 0) + (y >= node.y0 + half ? 2 : 0);
+    }
+
+    std::vector<QuadNode> m_nodes;
+};
+
+} // namespace
+
+bool ForceLayout::refine(const CompactDFA& dfa, std::vector<double>& x, std::vector<double>& y, double spacing,
+                         unsigned iterations, unsigned threads, const std::atomic<bool>* cancel) {
+    const uint32_t n = dfa.numStates();
+    const uint32_t k = dfa.numSymbols();
+    if (n < 2) return true;
+    if (iterations == 0) iterations = n <= 1000 ? 300 : n <= 20000 ? 100 : 30;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    if (n < 4096) threads = 1;
+
+    // Repulsion k²/d, attraction d²/k (k = spacing)
+    const double k2 = spacing * spacing;
+    double extent = std::max(*std::max_element(x.begin(), x.end()) - *std::min_element(x.begin(), x.end()),
+                             *std::max_element(y.begin(), y.end()) - *std::min_element(y.begin(), y.end()));
+    // Large enough to untangle the start layout, cooled linearly to zero
+    const double hot = std::max(spacing, 0.1 * extent);
+
+    QuadTree tree;
+    std::vector<double> dx(n), dy(n);
+    std::vector<std::vector<uint32_t>> stacks(threads);
+
+    for (unsigned it = 0; it < iterations; ++it) {
+        if (cancel && *cancel) return false;
+        const double limit = hot * (1.0 - double(it) / iterations);
+
+        // The tree is read-only while the forces are summed, one chunk per thread
+        tree.build(x, y, spacing / 64);
+        auto repel = [&](unsigned t, uint32_t begin, uint32_t end) {
+            for (uint32_t q = begin; q < end; ++q) {
+                dx[q] = dy[q] = 0;
+                tree.repulsion(x[q], y[q], k2, dx[q], dy[q], stacks[t]);
+            }
+        };
+        if (threads == 1) {
+            repel(0, 0, n);
+        } else {
+            std::vector<std::thread> pool;
+            uint32_t chunk = (n + threads - 1) / threads;
+            for (unsigned t = 0; t < threads; ++t) {
+                uint32_t begin = std::min(n, t * chunk), end = std::min(n, begin + chunk);
+                pool.emplace_back(repel, t, begin, end);
+            }
+            for (auto& th : pool) th.join();
+        }
+
+        // Attraction along transitions, both endpoints
+        for (uint32_t q = 0; q < n; ++q) {
+            const uint32_t* r = dfa.row(q);
+            for (uint32_t a = 0; a < k; ++a) {
+                uint32_t t = r[a];
+                if (t == CompactDFA::NONE || t == q) continue;
+                double ddx = x[q] - x[t], ddy = y[q] - y[t];
+                double f = std::sqrt(ddx * ddx + ddy * ddy) / spacing;
+                dx[q] -= ddx * f;
+                dy[q] -= ddy * f;
+                dx[t] += ddx * f;
+                dy[t] += ddy * f;
+            }
+        }
+
+        // Move each state at most `limit`
+        for (uint32_t q = 0; q < n; ++q) {
+            double len = std::sqrt(dx[q] * dx[q] + dy[q] * dy[q]);
+            if (len <= 0) continue;
+            double s = std::min(len, limit) / len;
+            x[q] += dx[q] * s;
+            y[q] += dy[q] * s;
+        }
+    }
+    return true;
+}
\ No newline at end of file
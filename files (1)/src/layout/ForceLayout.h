@@ -0,0 +1,23 @@
+#pragma once
+#include "../model/CompactDFA.h"
+#include <atomic>
+#include <vector>
+
+// Force-directed refinement (Fruchterman–Reingold). Transitions pull their
+// endpoints together and every pair of states pushes apart. Repulsion is
+// approximated with a Barnes–Hut quadtree rebuilt every iteration: a group
+// of states that is far away compared with its size acts as one mass at its
+// centre, so an iteration costs O(n log n + n·|Σ|) instead of O(n²),
+// however unevenly the states are spread. The displacement limit cools
+// linearly to zero, so the result is deterministic for a given start.
+class ForceLayout {
+public:
+    // Opening angle: cells smaller than Theta times their distance are merged
+    static constexpr double Theta = 1.2;
+
+    // Improves the positions in x and y in place; false when cancelled.
+    // iterations == 0 picks a count from the size of the automaton;
+    // threads == 0 uses std::thread::hardware_concurrency().
+    static bool refine(const CompactDFA& dfa, std::vector<double>& x, std::vector<double>& y, double spacing,
+                       unsigned iterations = 0, unsigned threads = 0, const std::atomic<bool>* cancel = nullptr);
+};
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "LayeredLayout.h"
+#include <algorithm>
+#include <cmath>
+
+bool LayeredLayout::layout(const CompactDFA& dfa, std::vector<double>& x, std::vector<double>& y, double spacing,
+                           const std::atomic<bool>* cancel) {
+    const uint32_t n = dfa.numStates();
+    const uint32_t k = dfa.numSymbols();
+    const uint32_t NONE = CompactDFA::NONE;
+    x.assign(n, 0.0);
+    y.assign(n, 0.0);
+    if (n == 0) return true;
+
+    // Rank by BFS depth: from the start state first, then from every state
+    // it cannot reach, in index order, one layer past the reachable part
+    std::vector<uint32_t> layer(n, NONE);
+    std::vector<uint32_t> queue;
+    queue.reserve(n);
+    uint32_t numLayers = 0;
+    auto bfs = [&](uint32_t root, uint32_t depth) {
+        size_t head = queue.size();
+        layer[root] = depth;
+        queue.push_back(root);
+        while (head < queue.size()) {
+            uint32_t q = queue[head++];
+            numLayers = std::max(numLayers, layer[q] + 1);
+            const uint32_t* r = dfa.row(q);
+            for (uint32_t a = 0; a < k; ++a) {
+                uint32_t t = r[a];
+                if (t != NONE && layer[t] == NONE) {
+                    layer[t] = layer[q] + 1;
+                    queue.push_back(t);
+                }
+            }
+        }
+    };
+    uint32_t start = dfa.startState();
+    if (start != NONE) bfs(start, 0);
+    const uint32_t unreachedDepth = numLayers;
+    for (uint32_t q = 0; q < n; ++q) {
+        if (layer[q] == NONE) bfs(q, unreachedDepth);
+    }
+
+    // Layer members, in discovery order to begin with
+    std::vector<uint32_t> layerStart(size_t(numLayers) + 1, 0);
+    for (uint32_t q = 0; q < n; ++q) ++layerStart[layer[q] + 1];
+    for (uint32_t l = 0; l < numLayers; ++l) layerStart[l + 1] += layerStart[l];
+    std::vector<uint32_t> members(n);
+    {
+        std::vector<uint32_t> fill(layerStart.begin(), layerStart.end() - 1);
+        for (uint32_t q : queue) members[fill[layer[q]]++] = q;
+    }
+
+    // Neighbours in either direction, self loops left out
+    std::vector<uint32_t> adjStart(size_t(n) + 1, 0);
+    for (uint32_t q = 0; q < n; ++q) {
+        const uint32_t* r = dfa.row(q);
+        for (uint32_t a = 0; a < k; ++a) {
+            if (r[a] == NONE || r[a] == q) continue;
+            ++adjStart[q + 1];
+            ++adjStart[r[a] + 1];
+        }
+    }
+    for (uint32_t q = 0; q < n; ++q) adjStart[q + 1] += adjStart[q];
+    std::vector<uint32_t> adj(adjStart[n]);
+    {
+        std::vector<uint32_t> fill(adjStart.begin(), adjStart.end() - 1);
+        for (uint32_t q = 0; q < n; ++q) {
+            const uint32_t* r = dfa.row(q);
+            for (uint32_t a = 0; a < k; ++a) {
+                if (r[a] == NONE || r[a] == q) continue;
+                adj[fill[q]++] = r[a];
+                adj[fill[r[a]]++] = q;
+            }
+        }
+    }
+
+    // Relative position within the layer, in [0, 1), so layers of different
+    // sizes can be compared
+    std::vector<double> pos(n), bary(n);
+    auto place = [&](uint32_t l) {
+        uint32_t size = layerStart[l + 1] - layerStart[l];
+        for (uint32_t i = 0; i < size; ++i) pos[members[layerStart[l] + i]] = (i + 0.5) / size;
+    };
+    for (uint32_t l = 0; l < numLayers; ++l) place(l);
+
+    // Alternate downward and upward barycenter sweeps
+    for (unsigned sweep = 0; sweep < Sweeps; ++sweep) {
+        if (cancel && *cancel) return false;
+        bool down = sweep % 2 == 0;
+        for (uint32_t i = 1; i < numLayers; ++i) {
+            uint32_t l = down ? i : numLayers - 1 - i;
+            uint32_t fixed = down ? l - 1 : l + 1;
+            uint32_t* begin = members.data() + layerStart[l];
+            uint32_t* end = members.data() + layerStart[l + 1];
+            for (uint32_t* p = begin; p != end; ++p) {
+                double sum = 0;
+                uint32_t count = 0;
+                for (uint32_t e = adjStart[*p]; e < adjStart[*p + 1]; ++e) {
+                    if (layer[adj[e]] != fixed) continue;
+                    sum += pos[adj[e]];
+                    ++count;
+                }
+                bary[*p] = count ? sum / count : pos[*p];
+            }
+            std::stable_sort(begin, end, [&](uint32_t a, uint32_t b) { return bary[a] < bary[b]; });
+            place(l);
+        }
+    }
+
+    // Columns left to right; a tall layer folds into several side by side
+    const uint32_t maxRows = std::max<uint32_t>(8, uint32_t(std::ceil(std::sqrt(double(n)))));
+    uint32_t column = 0;
+    for (uint32_t l = 0; l < numLayers; ++l) {
+        uint32_t size = layerStart[l + 1] - layerStart[l];
+        uint32_t cols = (size + maxRows - 1) / maxRows;
+        uint32_t rows = (size + cols - 1) / cols;
+        for (uint32_t i = 0; i < size; ++i) {
+            uint32_t q = members[layerStart[l] + i];
+            x[q] = (column + i % cols) * spacing;
+            y[q] = (double(i / cols) - (rows - 1) / 2.0) * spacing;
+        }
+        column += cols;
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+#include "../model/CompactDFA.h"
+#include <atomic>
+#include <vector>
+
+// Layered (Sugiyama-style) placement. States are ranked by BFS depth from
+// the start state, so the layers read left to right the way input is
+// consumed; states the start cannot reach follow in layers of their own.
+// A few barycenter sweeps then order each layer by the mean position of its
+// neighbours in the adjacent layer, which removes most crossings on
+// automata that are mostly forward. Layers taller than about √n states are
+// folded into several columns to keep the drawing roughly square.
+// O(n·|Σ| + n log n) per sweep.
+class LayeredLayout {
+public:
+    static constexpr unsigned Sweeps = 4;
+
+    // Fills x and y (resized to numStates); false when cancelled
+    static bool layout(const CompactDFA& dfa, std::vector<double>& x, std::vector<double>& y, double spacing,
+                       const std::atomic<bool>* cancel = nullptr);
+};
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "Layout.h"
+#include "LayeredLayout.h"
+#include "ForceLayout.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+bool Layout::apply(CompactDFA& dfa, const LayoutOptions& options) {
+    std::vector<double> x, y;
+    if (!LayeredLayout::layout(dfa, x, y, options.spacing, options.cancel)) return false;
+    if (options.algorithm == LayoutAlgorithm::ForceDirected &&
+        !ForceLayout::refine(dfa, x, y, options.spacing, options.iterations, options.threads, options.cancel)) {
+        return false;
+    }
+    if (x.empty()) return true;
+
+    // Top-left state one spacing in from the origin, like a hand-drawn graph
+    double minX = *std::min_element(x.begin(), x.end());
+    double minY = *std::min_element(y.begin(), y.end());
+    for (uint32_t q = 0; q < dfa.numStates(); ++q) {
+        dfa.setPosition(q, x[q] - minX + options.spacing, y[q] - minY + options.spacing);
+    }
+    return true;
+}
+
+bool Layout::apply(DFA& dfa, const LayoutOptions& options) {
+    CompactDFA compact = CompactDFA::fromDFA(dfa);
+    if (!apply(compact, options)) return false;
+    // fromDFA keeps one compact state per DFA state, in order
+    for (uint32_t q = 0; q < compact.numStates(); ++q) {
+        dfa.states[q].x = compact.x(q);
+        dfa.states[q].y = compact.y(q);
+    }
+    return true;
+}
+
+bool Layout::needsLayout(const DFA& dfa) {
+    std::vector<std::pair<double, double>> positions;
+    positions.reserve(dfa.states.size());
+    for (const auto& s : dfa.states) positions.push_back({s.x, s.y});
+    std::sort(positions.begin(), positions.end());
+    return std::adjacent_find(positions.begin(), positions.end()) != positions.end();
+}
+
+const char* Layout::name(LayoutAlgorithm algorithm) {
+    switch (algorithm) {
+    case LayoutAlgorithm::ForceDirected: return "force";
+    case LayoutAlgorithm::Layered:
+    default: return "layered";
+    }
+}
+
+bool Layout::parse(const std::string& name, LayoutAlgorithm& algorithm) {
+    for (auto a : {LayoutAlgorithm::Layered, LayoutAlgorithm::ForceDirected}) {
+        if (name == Layout::name(a)) {
+            algorithm = a;
+            return true;
+        }
+    }
+    return false;
+}
\ No newline at end of file
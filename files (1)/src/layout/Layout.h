@@ -0,0 +1,34 @@
+#pragma once
+#include "../model/DFA.h"
+#include "../model/CompactDFA.h"
+#include <atomic>
+
+enum class LayoutAlgorithm {
+    Layered,      // BFS-depth layers with barycenter ordering; fast, good for mostly forward automata
+    ForceDirected // layered start refined by Fruchterman–Reingold with Barnes–Hut repulsion; better for cyclic graphs
+};
+
+struct LayoutOptions {
+    LayoutAlgorithm algorithm = LayoutAlgorithm::Layered;
+    double spacing = 120;          // target distance between neighbouring states
+    unsigned iterations = 0;       // ForceDirected only; 0 = chosen from the size
+    unsigned threads = 0;          // ForceDirected only; 0 = all hardware threads
+    const std::atomic<bool>* cancel = nullptr; // polled between passes; set it to stop early
+};
+
+// Automatic placement: writes DFAState::x/y (or CompactDFA positions).
+// Pure computation with no GUI dependency, so it can run on any thread.
+class Layout {
+public:
+    // Both return false, leaving the positions untouched, when cancelled
+    static bool apply(CompactDFA& dfa, const LayoutOptions& options = {});
+    static bool apply(DFA& dfa, const LayoutOptions& options = {});
+
+    // True when two states share a position, e.g. a JSON import without
+    // coordinates or a sink added at the origin
+    static bool needsLayout(const DFA& dfa);
+
+    static const char* name(LayoutAlgorithm algorithm);
+    // Accepts the names returned by name(); returns false for anything else
+    static bool parse(const std::string& name, LayoutAlgorithm& algorithm);
+};
\ No newline at end of file
@@ -1,9 +1,135 @@
 #include <QApplication>
 #include "MainWindow.h"
 #include "model/DFA.h"
+#include "model/CompactDFA.h"
+#include "io/DFABinary.h"
+#include "io/DFAJsonStream.h"
+#include "io/Regex.h"
+#include "algorithms/AlphabetClasses.h"
+#include "algorithms/Equivalence.h"
 #include "algorithms/Hopcroft.h"
+#include "algorithms/IncrementalMinimizer.h"
+#include "algorithms/Minimizer.h"
+#include "algorithms/Product.h"
+#include "algorithms/Quotient.h"
+#include "algorithms/SubsetConstruction.h"
+#include "match/CompiledDFA.h"
+#include "layout/Layout.h"
+#include <QBuffer>
 #include <iostream>
+#include <map>
 #include <cassert>
+#include <random>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <regex>
+
+static bool sameDFA(const DFA& a, const DFA& b) {
+    if (a.alphabet != b.alphabet || a.transitions != b.transitions) return false;
+    if (a.states.size() != b.states.size()) return false;
+    for (size_t i = 0; i < a.states.size(); ++i) {
+        const auto& s = a.states[i];
+        const auto& t = b.states[i];
+        if (s.id != t.id || s.isStart != t.isStart || s.isAccept != t.isAccept || s.x != t.x || s.y != t.y) return false;
+    }
+    return true;
+}
+
+// Random DFA with n states over k symbols; each transition exists with probability density
+static DFA randomDFA(unsigned seed, int n, int k, double density) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    std::bernoulli_distribution present(density), accept(0.3);
+    DFA dfa;
+    for (int c = 0; c < k; ++c) dfa.alphabet.push_back(std::string(1, char('a' + c)));
+    for (int i = 0; i < n; ++i) dfa.addState("q" + std::to_string(i), i == 0, accept(rng), 0, 0);
+    for (int i = 0; i < n; ++i) {
+        for (const auto& sym : dfa.alphabet) {
+            if (present(rng)) dfa.addTransition("q" + std::to_string(i), sym, "q" + std::to_string(pick(rng)));
+        }
+    }
+    return dfa;
+}
+
+// Missing transitions reject
+static bool accepts(const DFA& dfa, const std::vector<std::string>& word) {
+    std::string q;
+    for (const auto& s : dfa.states) {
+        if (s.isStart) { q = s.id; break; }
+    }
+    if (q.empty()) return false;
+    for (const auto& sym : word) {
+        auto it = dfa.transitions.find({q, sym});
+        if (it == dfa.transitions.end()) return false;
+        q = it->second;
+    }
+    const DFAState* s = dfa.getState(q);
+    return s && s->isAccept;
+}
+
+// Every word over the alphabet up to the given length
+static std::vector<std::vector<std::string>> allWords(const std::vector<std::string>& alphabet, size_t maxLen) {
+    std::vector<std::vector<std::string>> words{{}};
+    for (size_t i = 0; i < words.size(); ++i) {
+        if (words[i].size() == maxLen) continue;
+        for (const auto& sym : alphabet) {
+            auto w = words[i];
+            w.push_back(sym);
+            words.push_back(w);
+        }
+    }
+    return words;
+}
+
+// Reference for Hopcroft: number of reachable states left after table-filling,
+// where a missing transition only agrees with another missing transition
+static size_t naiveClasses(const DFA& dfa) {
+    std::map<std::string, size_t> index;
+    std::vector<std::string> order;
+    for (const auto& s : dfa.states) {
+        if (s.isStart) { index[s.id] = 0; order.push_back(s.id); break; }
+    }
+    for (size_t i = 0; i < order.size(); ++i) {
+        for (const auto& sym : dfa.alphabet) {
+            auto it = dfa.transitions.find({order[i], sym});
+            if (it != dfa.transitions.end() && index.emplace(it->second, order.size()).second) order.push_back(it->second);
+        }
+    }
+    const size_t n = order.size(), missing = n;
+    std::vector<std::vector<size_t>> next(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (const auto& sym : dfa.alphabet) {
+            auto it = dfa.transitions.find({order[i], sym});
+            next[i].push_back(it == dfa.transitions.end() ? missing : index[it->second]);
+        }
+    }
+    std::vector<std::vector<bool>> marked(n + 1, std::vector<bool>(n + 1, false));
+    for (size_t p = 0; p <= n; ++p) {
+        for (size_t q = 0; q <= n; ++q) {
+            marked[p][q] = (p == missing) != (q == missing)
+                || (p < n && q < n && dfa.getState(order[p])->isAccept != dfa.getState(order[q])->isAccept);
+        }
+    }
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t p = 0; p < n; ++p) {
+            for (size_t q = 0; q < n; ++q) {
+                if (marked[p][q]) continue;
+                for (size_t c = 0; c < dfa.alphabet.size() && !marked[p][q]; ++c) {
+                    if (marked[next[p][c]][next[q][c]]) marked[p][q] = changed = true;
+                }
+            }
+        }
+    }
+    size_t classes = 0;
+    for (size_t p = 0; p < n; ++p) {
+        bool first = true;
+        for (size_t q = 0; q < p && first; ++q) first = marked[p][q];
+        classes += first;
+    }
+    return classes;
+}
 
 // Simple logic test
 void runTests() {
@@ -35,17 +161,695 @@ void runTests() {
     auto res2 = Hopcroft::minimize(dfa2);
     assert(res2.first.states.size() == 1);
     std::cout << "Test 2 Passed." << std::endl;
+
+    // Compact core round trip
+    DFA dfa3 = dfa;
+    dfa3.addState("q2", false, false, 10, 20);
+    dfa3.addTransition("q2", "c", "q0"); // symbol outside the alphabet
+    CompactDFA compact = CompactDFA::fromDFA(dfa3);
+    assert(compact.numStates() == 3 && compact.numSymbols() == 2);
+    assert(compact.next(compact.stateIndex("q0"), compact.symbolIndex("a")) == compact.stateIndex("q1"));
+    assert(compact.next(compact.stateIndex("q2"), compact.symbolIndex("a")) == CompactDFA::NONE);
+    assert(compact.startState() == 0 && compact.isAccept(1));
+    DFA back = compact.toDFA();
+    assert(back.alphabet == dfa3.alphabet && back.transitions == dfa3.transitions);
+    assert(back.states.size() == 3 && back.states[2].x == 10 && back.states[2].y == 20);
+    std::cout << "Test 3 Passed." << std::endl;
+
+    // Traced and fast Hopcroft agree, and both match a naive table-filling
+    // reference in size and language
+    assert(sameDFA(Hopcroft::minimizeFast(dfa), res.first));
+    assert(sameDFA(Hopcroft::minimizeFast(dfa2), res2.first));
+    for (unsigned seed = 1; seed <= 30; ++seed) {
+        DFA r = randomDFA(seed, 5 + seed * 2, 1 + seed % 3, seed % 2 ? 1.0 : 0.7);
+        DFA fast = Hopcroft::minimizeFast(r);
+        assert(sameDFA(fast, Hopcroft::minimize(r).first));
+        assert(fast.states.size() == naiveClasses(r));
+        for (const auto& w : allWords(r.alphabet, 6)) assert(accepts(fast, w) == accepts(r, w));
+    }
+    std::cout << "Test 4 Passed." << std::endl;
+
+    // Valmari-Lehtinen on partial DFAs == Hopcroft on the sink completion, minus the sink
+    MinimizerOptions valmari;
+    valmari.algorithm = MinimizerAlgorithm::Valmari;
+    for (unsigned seed = 1; seed <= 30; ++seed) {
+        DFA r = randomDFA(seed, 5 + seed * 2, 1 + seed % 3, seed % 2 ? 1.0 : 0.6);
+        DFA partial = Minimizer::minimize(r, valmari);
+        DFA completed = r;
+        completed.completeWithSink();
+        DFA complete = Hopcroft::minimizeFast(completed);
+        bool hasDead = false;
+        for (const auto& st : complete.states) {
+            bool loops = !st.isAccept;
+            for (const auto& sym : complete.alphabet) {
+                auto it = complete.transitions.find({st.id, sym});
+                loops = loops && it != complete.transitions.end() && it->second == st.id;
+            }
+            hasDead = hasDead || loops;
+        }
+        assert(partial.states.size() == complete.states.size() - (hasDead && complete.states.size() > 1 ? 1 : 0));
+        for (const auto& w : allWords(r.alphabet, 6)) assert(accepts(partial, w) == accepts(r, w));
+    }
+    std::cout << "Test 5 Passed." << std::endl;
+
+    // Parallel Moore matches Hopcroft for any thread count
+    MinimizerOptions parallel;
+    parallel.algorithm = MinimizerAlgorithm::ParallelMoore;
+    for (unsigned seed = 1; seed <= 30; ++seed) {
+        DFA r = randomDFA(seed, 5 + seed * 2, 1 + seed % 3, seed % 2 ? 1.0 : 0.7);
+        DFA expected = Hopcroft::minimizeFast(r);
+        for (unsigned threads : {1u, 3u, 8u}) {
+            parallel.threads = threads;
+            assert(sameDFA(Minimizer::minimize(r, parallel), expected));
+        }
+    }
+    CompactDFA big = CompactDFA::fromDFA(randomDFA(99, 20000, 2, 1.0));
+    parallel.threads = 4;
+    assert(sameDFA(Minimizer::minimize(big, parallel).toDFA(), Hopcroft::minimize(big).toDFA()));
+    std::cout << "Test 6 Passed." << std::endl;
+
+    // Binary format round trip
+    DFA sample = randomDFA(7, 50, 3, 0.8);
+    CompactDFA loaded;
+    QString binErr;
+    assert(DFABinary::fromBinary(DFABinary::toBinary(CompactDFA::fromDFA(sample)), loaded, binErr));
+    assert(sameDFA(loaded.toDFA(), sample));
+    assert(!DFABinary::fromBinary(DFABinary::toBinary(loaded).left(64), loaded, binErr));
+    // A state id running past its section is refused, not read as ""
+    QByteArray corrupt = DFABinary::toBinary(CompactDFA::fromDFA(sample));
+    uint64_t statesOffset;
+    std::memcpy(&statesOffset, corrupt.constData() + 32, 8);
+    const uint32_t pastEnd = 0x7FFFFFFF;
+    std::memcpy(corrupt.data() + statesOffset + 4 * sample.states.size(), &pastEnd, 4);
+    assert(!DFABinary::fromBinary(corrupt, loaded, binErr));
+    std::cout << "Test 7 Passed." << std::endl;
+
+    // Streaming JSON round trip, including transitions listed before states
+    QBuffer jsonBuf;
+    jsonBuf.open(QIODevice::ReadWrite);
+    assert(DFAJsonStream::write(jsonBuf, sample));
+    jsonBuf.seek(0);
+    DFA streamed;
+    assert(DFAJsonStream::read(jsonBuf, streamed, binErr));
+    assert(sameDFA(streamed, sample));
+    QBuffer early;
+    early.setData("{\"transitions\": [{\"from\": \"p\", \"symbol\": \"a\", \"to\": \"p\"}],"
+                  " \"states\": [{\"id\": \"p\", \"start\": true, \"accept\": true}], \"alphabet\": [\"a\"]}");
+    early.open(QIODevice::ReadOnly);
+    assert(DFAJsonStream::read(early, loaded, binErr));
+    assert(loaded.numStates() == 1 && loaded.next(0, 0) == 0 && loaded.isAccept(0));
+    QBuffer broken;
+    broken.setData("{\"states\": [");
+    broken.open(QIODevice::ReadOnly);
+    assert(!DFAJsonStream::read(broken, streamed, binErr));
+    // A UTF-8 byte order mark is skipped, as QJsonDocument does
+    QBuffer bom;
+    bom.setData("\xEF\xBB\xBF{\"alphabet\": [\"a\"], \"states\": [{\"id\": \"p\", \"start\": true}]}");
+    bom.open(QIODevice::ReadOnly);
+    assert(DFAJsonStream::read(bom, streamed, binErr) && streamed.states.size() == 1);
+    std::cout << "Test 8 Passed." << std::endl;
+
+    // Compiled matcher agrees with a direct walk, in one piece and streamed
+    for (unsigned seed = 0; seed < 10; ++seed) {
+        DFA r = randomDFA(seed, 12, 2, 0.8);
+        CompiledDFA m = CompiledDFA::compile(Hopcroft::minimize(CompactDFA::fromDFA(r)));
+        for (const auto& w : allWords(r.alphabet, 6)) {
+            std::string text;
+            std::vector<uint32_t> symbols;
+            for (const auto& sym : w) {
+                text += sym;
+                symbols.push_back(uint32_t(sym[0] - 'a'));
+            }
+            bool expected = accepts(r, w);
+            assert(m.accepts(text) == expected);
+            assert(m.acceptsSymbols(symbols.data(), symbols.size()) == expected);
+            size_t half = text.size() / 2;
+            assert(m.isAccept(m.run(m.run(m.start(), text.substr(0, half)), text.substr(half))) == expected);
+        }
+    }
+    CompiledDFA endsWithA = CompiledDFA::compile(dfa);
+    std::vector<uint8_t> lineResults;
+    assert(endsWithA.acceptsLines("a\nba\nab\nxa\n\nbba", lineResults) == 6);
+    assert((lineResults == std::vector<uint8_t>{1, 1, 0, 0, 0, 1}));
+    std::cout << "Test 9 Passed." << std::endl;
+
+    // Multi-stream kernels give the same bitmap as one-at-a-time matching
+    std::mt19937 textRng(5);
+    std::vector<std::string> texts(203);
+    for (auto& t : texts) {
+        for (size_t len = textRng() % 40; len > 0; --len) t += char('a' + textRng() % 3);
+    }
+    std::vector<std::string_view> views(texts.begin(), texts.end());
+    for (unsigned seed = 0; seed < 5; ++seed) {
+        CompiledDFA m = CompiledDFA::compile(Hopcroft::minimize(CompactDFA::fromDFA(randomDFA(seed, 30, 2, 0.9))));
+        std::vector<uint64_t> expected = m.acceptsBitmap(views, MatchKernel::Scalar);
+        for (size_t i = 0; i < views.size(); ++i) assert(bool(expected[i / 64] >> (i % 64) & 1) == m.accepts(views[i]));
+        for (auto kernel : {MatchKernel::Interleaved, MatchKernel::Avx2, MatchKernel::Auto}) {
+            assert(m.acceptsBitmap(views, kernel) == expected);
+        }
+    }
+    std::cout << "Test 10 Passed." << std::endl;
+
+    // Step timeline: replaying every split ends in the final partition, and
+    // random access agrees with walking forward
+    for (unsigned seed = 0; seed < 10; ++seed) {
+        DFA r = randomDFA(seed, 40, 2, 0.9);
+        auto traced = Hopcroft::minimize(r);
+        const HopcroftTimeline& timeline = traced.second;
+        CompactDFA reachable = CompactDFA::fromDFA(r).reachablePart();
+        std::vector<uint32_t> classOf;
+        uint32_t numClasses = Hopcroft::refine(reachable, classOf);
+        assert(traced.first.states.size() == numClasses);
+        std::vector<uint32_t> replayed = timeline.partitionAt(uint32_t(timeline.trace().splits.size()));
+        assert(Quotient::canonicalize(replayed) == numClasses && replayed == classOf);
+        assert(timeline.trace().moved.size() <= reachable.numStates() * 6); // n log2 n
+        HopcroftTimeline small(reachable, timeline.trace(), 3);
+        std::vector<std::vector<uint32_t>> forward;
+        for (size_t i = 0; i < small.numSteps(); ++i) forward.push_back(small.before(i));
+        for (size_t i = small.numSteps(); i-- > 0;) assert(small.before(i) == forward[i]);
+        for (size_t i = 0; i < small.numSteps(); i += 2) {
+            assert(small.before(i) == forward[i]);
+            assert(!small.splitBlocks(i).empty() && !small.preimage(i).empty());
+        }
+        if (small.numSteps() > 0) {
+            const std::vector<uint32_t>& before = small.before(0);
+            const std::vector<uint32_t>& after = small.after(0);
+            assert(before == forward[0] && before != after); // both held at once
+        }
+    }
+    std::cout << "Test 11 Passed." << std::endl;
+
+    // Trace levels: same result at every level; Summary counts what Full records
+    for (unsigned seed = 0; seed < 10; ++seed) {
+        DFA r = randomDFA(seed, 40, 3, 0.8);
+        auto none = Hopcroft::minimize(r, TraceLevel::None);
+        auto summary = Hopcroft::minimize(r, TraceLevel::Summary);
+        auto full = Hopcroft::minimize(r, TraceLevel::Full);
+        assert(sameDFA(none.first, full.first) && sameDFA(summary.first, full.first));
+        assert(none.second.empty() && none.second.trace().stats.splitters == 0);
+        const HopcroftTrace& t = full.second.trace();
+        const HopcroftStats& s = summary.second.trace().stats;
+        assert(summary.second.empty() && s.steps == t.steps.size() && s.splits == t.splits.size());
+        assert(s.moved == t.moved.size() && s.blocks == full.first.states.size());
+        HopcroftRecorder counter(TraceLevel::Summary);
+        MinimizerOptions observed;
+        observed.observer = &counter;
+        assert(sameDFA(Minimizer::minimize(r, observed), full.first));
+        assert(counter.trace().stats.splits == s.splits);
+    }
+    std::cout << "Test 12 Passed." << std::endl;
+
+    // Cancellation: the run stops before the next splitter once asked to
+    struct StopAfter : HopcroftRecorder {
+        uint64_t limit;
+        StopAfter(uint64_t n) : HopcroftRecorder(TraceLevel::Full), limit(n) {}
+        bool cancelled() override { return trace().stats.splitters >= limit; }
+    };
+    {
+        DFA r = randomDFA(3, 60, 2, 0.9);
+        StopAfter once(1);
+        auto stopped = Hopcroft::minimize(r, once);
+        assert(stopped.second.trace().stats.splitters == 1);
+        StopAfter never(~0ull);
+        auto complete = Hopcroft::minimize(r, never);
+        assert(sameDFA(complete.first, Hopcroft::minimize(r).first));
+        assert(complete.second.numSteps() == Hopcroft::minimize(r).second.numSteps());
+    }
+    std::cout << "Test 13 Passed." << std::endl;
+
+    // Layout: distinct positions, start state leftmost, cancel leaves positions alone
+    for (unsigned seed = 0; seed < 6; ++seed) {
+        DFA r = randomDFA(seed, 200, 2, 0.8);
+        assert(Layout::needsLayout(r));
+        for (auto algorithm : {LayoutAlgorithm::Layered, LayoutAlgorithm::ForceDirected}) {
+            DFA placed = r;
+            LayoutOptions options;
+            options.algorithm = algorithm;
+            assert(Layout::apply(placed, options) && !Layout::needsLayout(placed));
+            for (const auto& st : placed.states) assert(std::isfinite(st.x) && std::isfinite(st.y));
+            if (algorithm == LayoutAlgorithm::Layered) {
+                for (const auto& st : placed.states) assert(placed.states[0].x <= st.x);
+            }
+        }
+        std::atomic<bool> cancel(true);
+        LayoutOptions cancelled;
+        cancelled.cancel = &cancel;
+        DFA untouched = r;
+        assert(!Layout::apply(untouched, cancelled) && sameDFA(untouched, r));
+        // Minimized states keep the place of their first member
+        DFA placed = r;
+        Layout::apply(placed);
+        DFA minDFA = Hopcroft::minimizeFast(placed);
+        assert(!Layout::needsLayout(minDFA));
+        placed.completeWithSink();
+        assert(!Layout::needsLayout(placed));
+    }
+    std::cout << "Test 14 Passed." << std::endl;
+
+    // Reachability, co-reachability and compaction against a plain search
+    for (unsigned seed = 0; seed < 20; ++seed) {
+        DFA r = randomDFA(seed, 30 + seed * 5, 1 + seed % 3, 0.4);
+        CompactDFA c = CompactDFA::fromDFA(r);
+        auto reaches = [&](uint32_t from, uint32_t to) {
+            std::vector<char> seen(c.numStates(), 0);
+            std::vector<uint32_t> stack{from};
+            seen[from] = 1;
+            while (!stack.empty()) {
+                uint32_t q = stack.back();
+                stack.pop_back();
+                if (q == to) return true;
+                for (uint32_t a = 0; a < c.numSymbols(); ++a) {
+                    uint32_t t = c.next(q, a);
+                    if (t != CompactDFA::NONE && !seen[t]) { seen[t] = 1; stack.push_back(t); }
+                }
+            }
+            return false;
+        };
+        Bitset reach = r.reachableStates(), co = r.coReachableStates();
+        for (uint32_t q = 0; q < c.numStates(); ++q) {
+            assert(reach.test(q) == reaches(0, q));
+            bool toAccept = false;
+            for (uint32_t f = 0; f < c.numStates(); ++f) toAccept = toAccept || (c.isAccept(f) && reaches(q, f));
+            assert(co.test(q) == toAccept);
+        }
+        CompactDFA inPlace = c;
+        std::vector<uint32_t> renumber = inPlace.compact(reach);
+        assert(sameDFA(inPlace.toDFA(), c.reachablePart().toDFA()) && inPlace.numStates() == reach.count());
+        for (uint32_t q = 0; q < c.numStates(); ++q) {
+            if (renumber[q] != CompactDFA::NONE) assert(inPlace.stateIndex(c.stateId(q)) == renumber[q]);
+        }
+        DFA pruned = r;
+        pruned.removeUnreachable();
+        assert(pruned.states.size() == reach.count() && pruned.getReachableStates().size() == reach.count());
+        DFA trimmed = r;
+        trimmed.trim();
+        assert(Hopcroft::minimize(trimmed).first.states.size() <= Hopcroft::minimize(r).first.states.size());
+        for (int w = 0; w < 100; ++w) {
+            std::vector<std::string> word;
+            for (int i = 0; i < w % 9; ++i) word.push_back(r.alphabet[(w * 7 + i * 3) % r.alphabet.size()]);
+            assert(accepts(trimmed, word) == accepts(r, word));
+        }
+    }
+    std::cout << "Test 15 Passed." << std::endl;
+
+    // Incremental re-minimization agrees with a full run after every edit
+    auto isomorphic = [](const CompactDFA& a, const CompactDFA& b) {
+        if (a.numStates() != b.numStates() || a.numSymbols() != b.numSymbols()) return false;
+        if (a.numStates() == 0) return true;
+        std::vector<uint32_t> map(a.numStates(), CompactDFA::NONE);
+        std::vector<uint32_t> queue{a.startState()};
+        map[a.startState()] = b.startState();
+        for (size_t head = 0; head < queue.size(); ++head) {
+            uint32_t p = queue[head], q = map[p];
+            if (a.isAccept(p) != b.isAccept(q)) return false;
+            for (uint32_t c = 0; c < a.numSymbols(); ++c) {
+                uint32_t s = a.next(p, c), t = b.next(q, b.symbolIndex(a.symbol(c)));
+                if ((s == CompactDFA::NONE) != (t == CompactDFA::NONE)) return false;
+                if (s == CompactDFA::NONE) continue;
+                if (map[s] == CompactDFA::NONE) { map[s] = t; queue.push_back(s); }
+                else if (map[s] != t) return false;
+            }
+        }
+        return true;
+    };
+    for (unsigned seed = 0; seed < 6; ++seed) {
+        // Forward-only transitions, so an edit's backward cone is usually small
+        std::mt19937 rng(seed);
+        CompactDFA c;
+        c.addSymbol("a");
+        c.addSymbol("b");
+        for (uint32_t q = 0; q < 120; ++q) c.addState("q" + std::to_string(q), q == 0, rng() % 3 == 0);
+        for (uint32_t q = 0; q + 1 < 120; ++q) {
+            for (uint32_t a = 0; a < 2; ++a) c.setTransition(q, a, q + 1 + rng() % std::min(8u, 119 - q));
+        }
+        IncrementalMinimizer inc;
+        assert(isomorphic(inc.minimize(c), Hopcroft::minimize(c)) && !inc.lastRun().incremental);
+        int locals = 0, smaller = 0;
+        for (int step = 0; step < 40; ++step) {
+            std::vector<DFAEdit> journal;
+            uint32_t q = rng() % c.numStates();
+            switch (rng() % 4) {
+            case 0:
+                c.setAccept(q, !c.isAccept(q));
+                journal.push_back({DFAEdit::AcceptChanged, c.stateId(q)});
+                break;
+            case 1:
+                c.setTransition(q, rng() % 2, rng() % 3 ? q + rng() % (c.numStates() - q) : CompactDFA::NONE);
+                journal.push_back({DFAEdit::TransitionsChanged, c.stateId(q)});
+                break;
+            case 2: {
+                uint32_t added = c.addState("n" + std::to_string(step), false, rng() % 2);
+                c.setTransition(added, 0, q);
+                c.setTransition(q, 1, added);
+                journal.push_back({DFAEdit::StateAdded, c.stateId(added)});
+                journal.push_back({DFAEdit::TransitionsChanged, c.stateId(q)});
+                break;
+            }
+            default:
+                if (c.isStart(q)) break;
+                for (uint32_t p = 0; p < c.numStates(); ++p) {
+                    for (uint32_t a = 0; a < c.numSymbols(); ++a) {
+                        if (c.next(p, a) == q) journal.push_back({DFAEdit::TransitionsChanged, c.stateId(p)});
+                    }
+                }
+                journal.push_back({DFAEdit::StateRemoved, c.stateId(q)});
+                Bitset keep(c.numStates());
+                for (uint32_t p = 0; p < c.numStates(); ++p) keep.assign(p, p != q);
+                c.compact(keep);
+            }
+            assert(isomorphic(inc.update(c, journal), Hopcroft::minimize(c)));
+            if (inc.lastRun().incremental) {
+                ++locals;
+                assert(inc.lastRun().reduced <= c.numStates());
+                smaller += inc.lastRun().reduced < c.numStates();
+            }
+        }
+        assert(locals > 0 && smaller > 0);
+        assert(isomorphic(inc.update(c, {{DFAEdit::Reloaded, ""}}), Hopcroft::minimize(c)) && !inc.lastRun().incremental);
+    }
+    std::cout << "Test 16 Passed." << std::endl;
+
+    // A reused workspace gives the plain run's result without reallocating
+    HopcroftWorkspace ws;
+    ws.reserve(200, 3);
+    const uint32_t* invBuffer = ws.inv.data();
+    const uint32_t* worklistBuffer = ws.worklist.data();
+    for (unsigned seed = 0; seed < 20; ++seed) {
+        CompactDFA c = CompactDFA::fromDFA(randomDFA(seed, 20 + seed * 9, 1 + seed % 3, seed % 2 ? 1.0 : 0.5));
+        CompactDFA reachable = c.reachablePart();
+        std::vector<uint32_t> expected, classOf;
+        uint32_t numClasses = Hopcroft::refine(reachable, expected);
+        assert(sameDFA(Hopcroft::minimize(c, ws).toDFA(), Quotient::build(reachable, expected, numClasses).toDFA()));
+        assert(Hopcroft::minimize(c, classOf, ws) == numClasses);
+        Bitset reach = c.reachable();
+        for (uint32_t q = 0, r = 0; q < c.numStates(); ++q) {
+            assert(classOf[q] == (reach.test(q) ? expected[r++] : CompactDFA::NONE));
+        }
+    }
+    assert(ws.inv.data() == invBuffer && ws.worklist.data() == worklistBuffer);
+    std::cout << "Test 17 Passed." << std::endl;
+
+    // Batch formats: one-line JSON documents and multi-record binary files
+    {
+        QByteArray lines, records;
+        QBuffer jsonOut(&lines), binOut(&records);
+        jsonOut.open(QIODevice::WriteOnly);
+        binOut.open(QIODevice::WriteOnly);
+        std::vector<CompactDFA> inputs;
+        QString error;
+        for (unsigned seed = 0; seed < 5; ++seed) {
+            inputs.push_back(CompactDFA::fromDFA(randomDFA(seed, 3 + seed * 4, 1 + seed % 3, 0.7)));
+            assert(DFAJsonStream::write(jsonOut, inputs.back(), DFAJsonStream::Compact));
+            jsonOut.write("\n", 1);
+            assert(DFABinary::writeRecord(binOut, inputs.back(), error) && records.size() % 8 == 0);
+        }
+        std::vector<qint64> offsets;
+        const uchar* data = reinterpret_cast<const uchar*>(records.constData());
+        assert(DFABinary::splitRecords(data, records.size(), offsets, error) && offsets.size() == inputs.size());
+        size_t lineStart = 0;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            qint64 end = i + 1 < offsets.size() ? offsets[i + 1] : records.size();
+            CompactDFA fromRecord, fromLine;
+            assert(DFABinary::fromBinary(data + offsets[i], end - offsets[i], fromRecord, error));
+            assert(sameDFA(fromRecord.toDFA(), inputs[i].toDFA()));
+            size_t newline = lines.toStdString().find('\n', lineStart);
+            QByteArray line(lines.constData() + lineStart, qsizetype(newline - lineStart));
+            lineStart = newline + 1;
+            QBuffer in(&line);
+            in.open(QIODevice::ReadOnly);
+            assert(DFAJsonStream::read(in, fromLine, error) && sameDFA(fromLine.toDFA(), inputs[i].toDFA()));
+        }
+        assert(lineStart == size_t(lines.size()));
+        assert(!DFABinary::splitRecords(data, records.size() - 4, offsets, error));
+    }
+    std::cout << "Test 18 Passed." << std::endl;
+
+    // Equivalence and inclusion against word enumeration
+    for (unsigned seed = 0; seed < 60; ++seed) {
+        DFA a = randomDFA(seed, 2 + seed % 4, 2, 0.7);
+        DFA b = seed % 3 ? randomDFA(seed + 1000, 2 + seed % 5, 1 + seed % 2, 0.7) : Hopcroft::minimizeFast(a);
+        DFA completed = a;
+        completed.completeWithSink();
+        assert(Equivalence::equivalent(a, Minimizer::minimize(a, {MinimizerAlgorithm::Valmari})));
+        assert(Equivalence::equivalent(a, completed) && Equivalence::included(a, completed));
+
+        std::vector<std::string> cex;
+        bool same = Equivalence::equivalent(a, b, &cex);
+        std::vector<std::string> sigma = a.alphabet;
+        if (b.alphabet.size() > sigma.size()) sigma = b.alphabet;
+        for (const auto& w : allWords(sigma, same ? 6 : cex.size())) {
+            if (!same && w.size() == cex.size()) break;
+            assert(accepts(a, w) == accepts(b, w));
+        }
+        if (!same) assert(accepts(a, cex) != accepts(b, cex));
+
+        std::vector<std::string> missing;
+        bool included = Equivalence::included(a, b, &missing);
+        for (const auto& w : allWords(sigma, included ? 6 : missing.size())) {
+            if (!included && w.size() == missing.size()) break;
+            assert(!accepts(a, w) || accepts(b, w));
+        }
+        if (!included) assert(accepts(a, missing) && !accepts(b, missing));
+        assert(same == (included && Equivalence::included(b, a)));
+    }
+    std::cout << "Test 19 Passed." << std::endl;
+
+    // On-the-fly products and complement against word enumeration
+    for (unsigned seed = 0; seed < 40; ++seed) {
+        DFA a = randomDFA(seed, 2 + seed % 5, 2, 0.6);
+        DFA b = randomDFA(seed + 500, 2 + seed % 3, 1 + seed % 2, 0.6);
+        CompactDFA ca = CompactDFA::fromDFA(a), cb = CompactDFA::fromDFA(b);
+        for (auto op : {ProductOp::Intersection, ProductOp::Union, ProductOp::SymmetricDifference, ProductOp::Difference}) {
+            CompactDFA product = Product::build(ca, cb, op);
+            CompactDFA minimal = Product::build(ca, cb, op, true);
+            assert(product.reachable().count() == product.numStates());
+            assert(product.numStates() <= (ca.numStates() + 1) * (cb.numStates() + 1));
+            assert(minimal.numStates() <= product.numStates() && Equivalence::equivalent(product, minimal));
+            DFA p = product.toDFA();
+            for (const auto& w : allWords(p.alphabet, 5)) {
+                bool inA = accepts(a, w), inB = accepts(b, w);
+                bool expected = op == ProductOp::Intersection ? inA && inB
+                              : op == ProductOp::Union ? inA || inB
+                              : op == ProductOp::SymmetricDifference ? inA != inB
+                              : inA && !inB;
+                assert(accepts(p, w) == expected);
+            }
+        }
+        DFA complement = Product::complement(a);
+        for (const auto& w : allWords(a.alphabet, 5)) assert(accepts(complement, w) != accepts(a, w));
+        assert(Equivalence::equivalent(Product::complement(complement), a));
+    }
+    // Ids with commas: ("1,2","3") and ("1","2,3") must stay two states
+    DFA commaA, commaB;
+    commaA.alphabet = commaB.alphabet = {"x"};
+    commaA.addState("1,2", true, false, 0, 0);
+    commaA.addState("1", false, true, 0, 0);
+    commaA.addTransition("1,2", "x", "1");
+    commaA.addTransition("1", "x", "1,2");
+    commaB.addState("3", true, false, 0, 0);
+    commaB.addState("2,3", false, true, 0, 0);
+    commaB.addTransition("3", "x", "2,3");
+    commaB.addTransition("2,3", "x", "3");
+    DFA commaProduct = Product::build(commaA, commaB, ProductOp::Intersection);
+    assert(commaProduct.states.size() == 2 && commaProduct.states[0].id != commaProduct.states[1].id);
+    assert(!accepts(commaProduct, {}) && accepts(commaProduct, {"x"}) && !accepts(commaProduct, {"x", "x"}));
+    ProductOp op;
+    assert(Product::parse("xor", op) && op == ProductOp::SymmetricDifference && !Product::parse("and", op));
+    std::cout << "Test 20 Passed." << std::endl;
+
+    // NFAs: conflicting DFA input, ε-closures and subset construction
+    DFA clash;
+    clash.alphabet = {"a"};
+    clash.addState("p", true, false, 0, 0);
+    clash.addState("q", false, true, 0, 0);
+    clash.addTransition("p", "a", "p");
+    clash.addTransition("p", "a", "p");
+    assert(clash.isDeterministic());
+    clash.addTransition("p", "a", "q");
+    assert(!clash.isDeterministic() && clash.conflicts.size() == 1 && clash.transitions.at({"p", "a"}) == "q");
+    assert(SubsetConstruction::needed(clash));
+    DFA determinized = SubsetConstruction::determinize(clash); // a+
+    assert(determinized.isDeterministic() && determinized.states.size() == 2);
+    assert(!accepts(determinized, {}) && accepts(determinized, {"a"}) && accepts(determinized, {"a", "a", "a"}));
+
+    for (unsigned seed = 0; seed < 40; ++seed) {
+        std::mt19937 rng(seed);
+        uint32_t n = 2 + seed % 6;
+        NFA nfa;
+        nfa.addSymbol("a");
+        nfa.addSymbol("b");
+        for (uint32_t q = 0; q < n; ++q) nfa.addState("n" + std::to_string(q), q == 0 || rng() % 5 == 0, rng() % 4 == 0);
+        for (uint32_t e = 0; e < 3 * n; ++e) {
+            uint32_t symbol = rng() % 4 == 0 ? NFA::Epsilon : uint32_t(rng() % 2);
+            nfa.addTransition(uint32_t(rng() % n), symbol, uint32_t(rng() % n));
+        }
+        // Reference: simulate on state sets
+        auto closeUnder = [&](std::vector<bool>& set) {
+            for (bool changed = true; changed;) {
+                changed = false;
+                for (const auto& e : nfa.edges()) {
+                    if (e.symbol == NFA::Epsilon && set[e.from] && !set[e.to]) set[e.to] = changed = true;
+                }
+            }
+        };
+        auto nfaAccepts = [&](const std::vector<std::string>& word) {
+            std::vector<bool> set(n);
+            for (uint32_t q = 0; q < n; ++q) set[q] = nfa.isStart(q);
+            closeUnder(set);
+            for (const auto& sym : word) {
+                std::vector<bool> next(n);
+                for (const auto& e : nfa.edges()) {
+                    if (e.symbol == nfa.symbolIndex(sym) && set[e.from]) next[e.to] = true;
+                }
+                closeUnder(next);
+                set = next;
+            }
+            for (uint32_t q = 0; q < n; ++q) {
+                if (set[q] && nfa.isAccept(q)) return true;
+            }
+            return false;
+        };
+        CompactDFA dfa = SubsetConstruction::determinize(nfa);
+        assert(dfa.numStates() <= (1u << n) && dfa.reachable().count() == dfa.numStates());
+        DFA d = dfa.toDFA();
+        for (const auto& w : allWords({"a", "b"}, 6)) assert(accepts(d, w) == nfaAccepts(w));
+    }
+
+    // (a|b)*a(a|b)^k needs 2^(k+1) states, all distinct; the limit stops the construction early
+    const uint32_t k = 10;
+    NFA suffix;
+    suffix.addSymbol("a");
+    suffix.addSymbol("b");
+    for (uint32_t q = 0; q <= k + 1; ++q) suffix.addState("s" + std::to_string(q), q == 0, q == k + 1);
+    suffix.addTransition(0, 0, 0);
+    suffix.addTransition(0, 1, 0);
+    suffix.addTransition(0, 0, 1);
+    for (uint32_t q = 1; q <= k; ++q) {
+        suffix.addTransition(q, 0, q + 1);
+        suffix.addTransition(q, 1, q + 1);
+    }
+    CompactDFA blowup = SubsetConstruction::determinize(suffix);
+    assert(blowup.numStates() == (1u << (k + 1)) && Hopcroft::minimize(blowup).numStates() == blowup.numStates());
+    CompactDFA partial;
+    assert(!SubsetConstruction::determinize(suffix, partial, 100) && partial.numStates() == 100);
+    // {1,2} from members "1" and "2" and from member "1,2" stay two states
+    NFA commas;
+    commas.addSymbol("a");
+    commas.addSymbol("b");
+    for (const char* id : {"s", "1", "2", "1,2"}) commas.addState(id, id[0] == 's', id[0] == '2');
+    commas.addTransition(0, 0, 1);
+    commas.addTransition(0, 0, 2);
+    commas.addTransition(0, 1, 3);
+    CompactDFA commaSubsets = SubsetConstruction::determinize(commas);
+    assert(commaSubsets.numStates() == 3 && commaSubsets.stateId(1) != commaSubsets.stateId(2));
+    assert(commaSubsets.isAccept(commaSubsets.next(0, 0)) && !commaSubsets.isAccept(commaSubsets.next(0, 1)));
+
+    // JSON read as an NFA: repeated pairs and ε ("") both count
+    QBuffer nfaJson;
+    nfaJson.setData("{\"alphabet\": [\"a\"], \"states\": [{\"id\": \"p\", \"start\": true}, {\"id\": \"q\"},"
+                    " {\"id\": \"r\", \"accept\": true}], \"transitions\": [{\"from\": \"p\", \"symbol\": \"a\", \"to\": \"p\"},"
+                    " {\"from\": \"p\", \"symbol\": \"a\", \"to\": \"q\"}, {\"from\": \"q\", \"symbol\": \"\", \"to\": \"r\"}]}");
+    nfaJson.open(QIODevice::ReadOnly);
+    NFA read;
+    assert(DFAJsonStream::read(nfaJson, read, binErr) && read.edges().size() == 3 && read.hasEpsilon());
+    assert(Equivalence::equivalent(SubsetConstruction::determinize(read).toDFA(), determinized));
+    // Several start states need the construction; a plain DFA goes back unchanged
+    QBuffer twoStarts;
+    twoStarts.setData("{\"alphabet\": [\"a\"], \"states\": [{\"id\": \"p\", \"start\": true},"
+                      " {\"id\": \"q\", \"start\": true, \"accept\": true}], \"transitions\": []}");
+    twoStarts.open(QIODevice::ReadOnly);
+    assert(DFAJsonStream::read(twoStarts, read, binErr) && SubsetConstruction::needed(read));
+    assert(accepts(SubsetConstruction::determinize(read).toDFA(), {}));
+    NFA plain = NFA::fromDFA(sample);
+    assert(!SubsetConstruction::needed(plain) && sameDFA(plain.toDFA(), sample));
+    std::cout << "Test 21 Passed." << std::endl;
+
+    // Regular expressions against std::regex on every word over {a, b, c} up to length 6
+    RegexOptions abc;
+    abc.alphabet = {"a", "b", "c"};
+    const std::vector<std::string> patterns = {"a(b|c)*", "(ab){2,3}c?", "[^a]+b", ".*abc.*", "a{0,2}b{2,}",
+                                               "(a|)b", "(?:a|bc)+", "[a-b]c*|c", "^a?b?c?$", "(a*b*)*c", "",
+                                               "ab", "abc", "ab", ".*cb", "a(b|c)*a"};
+    for (size_t i = 0; i <= patterns.size(); ++i) {
+        // Each pattern alone, then all of them as one alternation
+        std::vector<std::string> chosen = i < patterns.size() ? std::vector<std::string>{patterns[i]} : patterns;
+        std::string joined;
+        for (const auto& p : chosen) {
+            std::string body = p;
+            if (!body.empty() && body.front() == '^') body.erase(0, 1);
+            if (!body.empty() && body.back() == '$') body.pop_back();
+            joined += (joined.empty() ? "(?:" : "|(?:") + body + ")";
+        }
+        std::regex reference(joined);
+        CompactDFA compiled;
+        QString regexError;
+        assert(Regex::compile(chosen, compiled, regexError, abc));
+        DFA d = Minimizer::minimize(compiled).toDFA();
+        for (const auto& w : allWords(abc.alphabet, 6)) {
+            std::string text;
+            for (const auto& sym : w) text += sym;
+            assert(accepts(d, w) == std::regex_match(text, reference));
+        }
+    }
+    CompactDFA suffixDFA;
+    QString regexError;
+    assert(Regex::compile({"(a|b)*a(a|b){3}"}, suffixDFA, regexError) && Minimizer::minimize(suffixDFA).numStates() == 16);
+    assert(Regex::compile({"\\d+\\.\\d*", "é[x-z]"}, suffixDFA, regexError) && suffixDFA.symbolIndex("é") != CompactDFA::NONE);
+    assert(suffixDFA.numSymbols() == 15);
+    for (const char* bad : {"(a", "a)", "*a", "[a", "a{3,1}", "[z-a]", "a\\"}) {
+        assert(!Regex::compile({"ok", bad}, suffixDFA, regexError) && regexError.toStdString().find("pattern 2") == 0);
+    }
+    assert(!Regex::compile({"ab)"}, suffixDFA, regexError) && regexError.toStdString() == "column 3: unbalanced ')'");
+    // Nested bounds multiply: refused by the NFA limit instead of built
+    NFA boundedNFA;
+    assert(!Regex::toNFA({"(a{0,1000}){0,1000}"}, boundedNFA, regexError) && boundedNFA.numStates() == 0);
+    RegexOptions small;
+    small.maxNFASize = 100;
+    assert(Regex::compile({"a{0,9}"}, suffixDFA, regexError, small));
+    assert(!Regex::compile({"a{0,30}"}, suffixDFA, regexError, small));
+    std::cout << "Test 22 Passed." << std::endl;
+
+    // Alphabet classes: same minimization with and without them, narrow matcher rows
+    for (unsigned seed = 0; seed < 30; ++seed) {
+        CompactDFA base = CompactDFA::fromDFA(randomDFA(seed, 3 + seed % 12, 3, 0.8));
+        // Seven symbols copying base's three columns, plus one without transitions
+        CompactDFA wide;
+        for (int c = 0; c < 8; ++c) wide.addSymbol("s" + std::to_string(c));
+        for (uint32_t q = 0; q < base.numStates(); ++q) {
+            wide.addState(base.stateId(q), base.isStart(q), base.isAccept(q));
+            for (uint32_t c = 0; c < 7; ++c) wide.setTransition(q, c, base.next(q, c % 3));
+        }
+        AlphabetClasses classes = AlphabetClasses::of(wide);
+        assert(classes.numClasses() <= 4 && classes.classOf(3) == classes.classOf(0) && classes.representative(classes.classOf(6)) == 0);
+        assert(sameDFA(classes.expand(classes.compress(wide), wide).toDFA(), wide.toDFA()));
+        for (auto algorithm : {MinimizerAlgorithm::Hopcroft, MinimizerAlgorithm::Valmari, MinimizerAlgorithm::ParallelMoore}) {
+            MinimizerOptions plain{algorithm};
+            plain.compressAlphabet = false;
+            assert(sameDFA(Minimizer::minimize(wide, {algorithm}).toDFA(), Minimizer::minimize(wide, plain).toDFA()));
+        }
+    }
+    RegexOptions bytes;
+    for (int b = 0; b < 256; ++b) bytes.alphabet.push_back(std::string(1, char(b)));
+    CompactDFA tokens;
+    assert(Regex::compile({"[A-Za-z_][A-Za-z0-9_]*", "[0-9]+(\\.[0-9]+)?"}, tokens, regexError, bytes));
+    CompactDFA minimalTokens = Minimizer::minimize(tokens);
+    assert(minimalTokens.numSymbols() == 256 && AlphabetClasses::of(minimalTokens).numClasses() <= 5);
+    CompiledDFA tokenMatcher = CompiledDFA::compile(minimalTokens);
+    assert(tokenMatcher.rowWidth() <= 8);
+    assert(tokenMatcher.accepts("foo_1") && tokenMatcher.accepts("12.5") && tokenMatcher.accepts("_"));
+    assert(!tokenMatcher.accepts("1.") && !tokenMatcher.accepts("a-b") && !tokenMatcher.accepts("\xff") && !tokenMatcher.accepts(""));
+    std::cout << "Test 23 Passed." << std::endl;
 }
 
 int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
-    
-    // Check for test flag
+    // Check for test flag; the logic tests need no GUI, so skip QApplication
     if (argc > 1 && std::string(argv[1]) == "--test") {
         runTests();
         return 0;
     }
 
+    QApplication app(argc, argv);
+
     MainWindow w;
     w.show();
     return app.exec();
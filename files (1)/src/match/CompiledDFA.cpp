@@ -0,0 +1,318 @@
+#include "CompiledDFA.h"
+#include "../algorithms/AlphabetClasses.h"
+#include <algorithm>
+#include <cstring>
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+bool CompiledDFA::compile(const CompactDFA& dfa, CompiledDFA& m) {
+    const uint32_t n = dfa.numStates();
+    const uint32_t k = dfa.numSymbols();
+    m = CompiledDFA();
+
+    // One table column per alphabet class. A class with no transitions at
+    // all behaves like a byte outside the alphabet and shares column 0.
+    const AlphabetClasses classes = AlphabetClasses::of(dfa);
+    std::vector<uint32_t> column(classes.numClasses(), 0);
+    uint32_t width = 1;
+    for (uint32_t c = 0; c < classes.numClasses(); ++c) {
+        for (uint32_t q = 0; q < n; ++q) {
+            if (dfa.next(q, classes.representative(c)) != CompactDFA::NONE) {
+                column[c] = width++;
+                break;
+            }
+        }
+    }
+
+    // Row width: the columns padded to a power of two
+    m.m_shift = 0;
+    while ((uint64_t(1) << m.m_shift) < width) ++m.m_shift;
+    const size_t stride = size_t(1) << m.m_shift;
+    if ((uint64_t(n) + 1) << m.m_shift > (uint64_t(1) << 32)) {
+        m = CompiledDFA();
+        return false;
+    }
+
+    m.m_table.assign((size_t(n) + 1) * stride, 0);
+    m.m_accept.assign(size_t(n) + 1, 0);
+    for (uint32_t q = 0; q < n; ++q) {
+        State* row = m.m_table.data() + (size_t(q) + 1) * stride;
+        const uint32_t* r = dfa.row(q);
+        for (uint32_t c = 0; c < classes.numClasses(); ++c) {
+            uint32_t to = r[classes.representative(c)];
+            if (column[c] != 0 && to != CompactDFA::NONE) row[column[c]] = State((size_t(to) + 1) * stride);
+        }
+        m.m_accept[q + 1] = dfa.isAccept(q) ? 1 : 0;
+    }
+
+    m.m_byteClass.fill(0);
+    m.m_symbolClass.resize(k);
+    for (uint32_t a = 0; a < k; ++a) {
+        m.m_symbolClass[a] = column[classes.classOf(a)];
+        const std::string& sym = dfa.symbol(a);
+        if (sym.size() == 1) m.m_byteClass[static_cast<unsigned char>(sym[0])] = m.m_symbolClass[a];
+    }
+
+    uint32_t start = dfa.startState();
+    m.m_start = start == CompactDFA::NONE ? 0 : State((size_t(start) + 1) * stride);
+    return true;
+}
+
+CompiledDFA CompiledDFA::compile(const CompactDFA& dfa) {
+    CompiledDFA m;
+    compile(dfa, m);
+    return m;
+}
+
+CompiledDFA CompiledDFA::compile(const DFA& dfa) {
+    return compile(CompactDFA::fromDFA(dfa));
+}
+
+CompiledDFA::State CompiledDFA::run(State s, const char* data, size_t size) const {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    const State* table = m_table.data();
+    const uint32_t* cls = m_byteClass.data();
+
+    // Unrolled; the dead check once per block stops hopeless inputs early
+    while (end - p >= 4) {
+        s = table[s + cls[p[0]]];
+        s = table[s + cls[p[1]]];
+        s = table[s + cls[p[2]]];
+        s = table[s + cls[p[3]]];
+        p += 4;
+        if (s == 0) return 0;
+    }
+    while (p < end) s = table[s + cls[*p++]];
+    return s;
+}
+
+bool CompiledDFA::acceptsSymbols(const uint32_t* symbols, size_t size) const {
+    State s = m_start;
+    for (size_t i = 0; i < size && s != 0; ++i) s = stepSymbol(s, symbols[i]);
+    return isAccept(s);
+}
+
+void CompiledDFA::acceptsAll(const std::string_view* inputs, size_t count, uint8_t* results) const {
+    for (size_t i = 0; i < count; ++i) results[i] = accepts(inputs[i]) ? 1 : 0;
+}
+
+std::vector<uint8_t> CompiledDFA::acceptsAll(const std::vector<std::string_view>& inputs) const {
+    std::vector<uint8_t> results(inputs.size());
+    acceptsAll(inputs.data(), inputs.size(), results.data());
+    return results;
+}
+
+size_t CompiledDFA::acceptsLines(std::string_view text, std::vector<uint8_t>& results) const {
+    results.clear();
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+        const char* lineEnd = nl ? nl : end;
+        results.push_back(isAccept(run(m_start, p, size_t(lineEnd - p))) ? 1 : 0);
+        p = nl ? nl + 1 : end;
+    }
+    return results.size();
+}
+
+namespace {
+
+constexpr size_t Lanes = 16;
+
+// Hands out the batch to the lanes of a multi-stream kernel and records the
+// results. Every lane holds a non-empty string; empty ones are answered on
+// the spot.
+class LaneFeeder {
+public:
+    LaneFeeder(const CompiledDFA& dfa, const std::string_view* inputs, size_t count, uint64_t* bitmap)
+        : m_dfa(dfa), m_inputs(inputs), m_count(count), m_bitmap(bitmap) {
+        std::fill(index, index + Lanes, count);
+    }
+
+    void finish(size_t i, uint32_t state) {
+        if (m_dfa.isAccept(state)) m_bitmap[i / 64] |= uint64_t(1) << (i % 64);
+    }
+
+    // Loads the next string into lane l; false (and the lane retired) when
+    // the batch is used up
+    bool take(size_t l) {
+        while (m_next < m_count) {
+            size_t i = m_next++;
+            if (m_inputs[i].empty()) {
+                finish(i, m_dfa.start());
+                continue;
+            }
+            p[l] = reinterpret_cast<const unsigned char*>(m_inputs[i].data());
+            end[l] = p[l] + m_inputs[i].size();
+            s[l] = m_dfa.start();
+            index[l] = i;
+            return true;
+        }
+        index[l] = m_count;
+        return false;
+    }
+
+    bool fill() {
+        for (size_t l = 0; l < Lanes; ++l) {
+            if (!take(l)) return false;
+        }
+        return true;
+    }
+
+    // Once fewer strings than lanes are left, they finish one by one
+    void drain() {
+        for (size_t l = 0; l < Lanes; ++l) {
+            if (index[l] != m_count) finish(index[l], m_dfa.run(s[l], reinterpret_cast<const char*>(p[l]), size_t(end[l] - p[l])));
+        }
+    }
+
+    const unsigned char* p[Lanes] = {};
+    const unsigned char* end[Lanes] = {};
+    alignas(32) uint32_t s[Lanes] = {};
+    size_t index[Lanes];
+
+private:
+    const CompiledDFA& m_dfa;
+    const std::string_view* m_inputs;
+    size_t m_count;
+    uint64_t* m_bitmap;
+    size_t m_next = 0;
+};
+
+// One step per lane per round; a finished lane is refilled in place
+void runInterleaved(LaneFeeder& f, const uint32_t* table, const uint32_t* cls) {
+    bool full = f.fill();
+    while (full) {
+        for (size_t l = 0; l < Lanes; ++l) {
+            f.s[l] = table[f.s[l] + cls[*f.p[l]++]];
+            if (f.p[l] == f.end[l]) {
+                f.finish(f.index[l], f.s[l]);
+                full = f.take(l) && full;
+            }
+        }
+    }
+    f.drain();
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define DFA_AVX2_KERNEL 1
+// The same schedule with the states in two 8-lane registers and the table
+// loads done by gathers. Remaining lengths are counted down alongside, so
+// finished lanes show up as a compare mask.
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((target("avx2")))
+#endif
+void runAvx2(LaneFeeder& f, const uint32_t* table, const uint32_t* cls) {
+    bool full = f.fill();
+    const int* base = reinterpret_cast<const int*>(table);
+    alignas(32) uint32_t c[Lanes];
+    alignas(32) uint32_t left[Lanes];
+    for (size_t l = 0; l < Lanes; ++l) left[l] = uint32_t(f.end[l] - f.p[l]);
+    __m256i s0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(f.s));
+    __m256i s1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(f.s + 8));
+    __m256i r0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(left));
+    __m256i r1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(left + 8));
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i zero = _mm256_setzero_si256();
+    while (full) {
+        // The class lookups do not depend on the states, so they run ahead
+        for (size_t l = 0; l < Lanes; ++l) c[l] = cls[*f.p[l]++];
+        s0 = _mm256_i32gather_epi32(base, _mm256_add_epi32(s0, _mm256_load_si256(reinterpret_cast<const __m256i*>(c))), 4);
+        s1 = _mm256_i32gather_epi32(base, _mm256_add_epi32(s1, _mm256_load_si256(reinterpret_cast<const __m256i*>(c + 8))), 4);
+        r0 = _mm256_sub_epi32(r0, one);
+        r1 = _mm256_sub_epi32(r1, one);
+        int done = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(r0, zero)))
+                 | _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(r1, zero))) << 8;
+        if (!done) continue;
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(f.s), s0);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(f.s + 8), s1);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(left), r0);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(left + 8), r1);
+        for (size_t l = 0; l < Lanes; ++l) {
+            if (!(done >> l & 1)) continue;
+            f.finish(f.index[l], f.s[l]);
+            full = f.take(l) && full;
+            left[l] = uint32_t(f.end[l] - f.p[l]);
+        }
+        s0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(f.s));
+        s1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(f.s + 8));
+        r0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(left));
+        r1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(left + 8));
+    }
+    _mm256_store_si256(reinterpret_cast<__m256i*>(f.s), s0);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(f.s + 8), s1);
+    f.drain();
+}
+
+bool cpuHasAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#else
+    int regs[4];
+    __cpuid(regs, 1);
+    bool osSaves = (regs[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6; // OSXSAVE, XMM+YMM state
+    __cpuidex(regs, 7, 0);
+    return osSaves && (regs[1] & (1 << 5));
+#endif
+}
+#endif
+
+} // namespace
+
+bool CompiledDFA::supported(MatchKernel kernel) {
+    if (kernel != MatchKernel::Avx2) return true;
+#ifdef DFA_AVX2_KERNEL
+    static const bool avx2 = cpuHasAvx2();
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+const char* CompiledDFA::name(MatchKernel kernel) {
+    switch (kernel) {
+    case MatchKernel::Scalar: return "scalar";
+    case MatchKernel::Interleaved: return "interleaved";
+    case MatchKernel::Avx2: return "avx2";
+    case MatchKernel::Auto:
+    default: return "auto";
+    }
+}
+
+void CompiledDFA::acceptsBitmap(const std::string_view* inputs, size_t count, uint64_t* bitmap, MatchKernel kernel) const {
+    std::fill(bitmap, bitmap + (count + 63) / 64, 0);
+    if (kernel == MatchKernel::Auto) kernel = MatchKernel::Interleaved;
+    if (kernel == MatchKernel::Avx2) {
+        // Gathers take signed 32-bit indices; lengths are counted in 32 bits
+        bool fits = supported(kernel) && m_table.size() <= 0x7FFFFFFFu;
+        for (size_t i = 0; i < count && fits; ++i) fits = inputs[i].size() <= 0xFFFFFFFFu;
+        if (!fits) kernel = MatchKernel::Interleaved;
+    }
+    if (kernel == MatchKernel::Scalar || count < Lanes) {
+        for (size_t i = 0; i < count; ++i) {
+            if (isAccept(run(m_start, inputs[i]))) bitmap[i / 64] |= uint64_t(1) << (i % 64);
+        }
+        return;
+    }
+
+    LaneFeeder feeder(*this, inputs, count, bitmap);
+#ifdef DFA_AVX2_KERNEL
+    if (kernel == MatchKernel::Avx2) {
+        runAvx2(feeder, m_table.data(), m_byteClass.data());
+        return;
+    }
+#endif
+    runInterleaved(feeder, m_table.data(), m_byteClass.data());
+}
+
+std::vector<uint64_t> CompiledDFA::acceptsBitmap(const std::vector<std::string_view>& inputs, MatchKernel kernel) const {
+    std::vector<uint64_t> bitmap((inputs.size() + 63) / 64);
+    acceptsBitmap(inputs.data(), inputs.size(), bitmap.data(), kernel);
+    return bitmap;
+}
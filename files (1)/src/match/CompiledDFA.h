@@ -0,0 +1,103 @@
+#pragma once
+#include "../model/DFA.h"
+#include "../model/CompactDFA.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <vector>
+
+// Kernels for matching many strings at once (CompiledDFA::acceptsBitmap)
+enum class MatchKernel {
+    Auto,        // Interleaved; gathers lose to plain loads on many x86 cores
+    Scalar,      // one string after another
+    Interleaved, // 16 strings in lock step, portable code
+    Avx2         // 16 strings in lock step with AVX2 gathers (x86-64, when the CPU has it)
+};
+
+// Executable form of a (minimized) automaton for matching input at memory
+// speed. Input bytes are mapped through a 256-entry table to alphabet classes
+// (AlphabetClasses: symbols with equal columns share one), so the table has
+// one column per class, not per symbol. Transitions live in one dense, 64-byte
+// aligned table whose rows are padded to a power of two, and states are kept
+// premultiplied (row offsets), so one step is a single table load:
+// next = table[state + class[byte]].
+//
+// Every one-byte alphabet symbol matches that byte; other bytes, missing
+// transitions and automata without a start state lead to a dead state that
+// loops on everything. Multi-byte symbols can only be fed through the symbol
+// API (stepSymbol / acceptsSymbols). The table is limited to 2^32 entries
+// ((states + 1) * padded row width).
+class CompiledDFA {
+public:
+    using State = uint32_t; // premultiplied row offset; see stateIndex()
+
+    // Returns false, with out rejecting everything, when the table would not
+    // fit in 2^32 entries
+    static bool compile(const CompactDFA& dfa, CompiledDFA& out);
+    // Same; an automaton past the limit gives a matcher that rejects everything
+    static CompiledDFA compile(const CompactDFA& dfa);
+    static CompiledDFA compile(const DFA& dfa);
+
+    State start() const { return m_start; }
+    State dead() const { return 0; }
+    bool isDead(State s) const { return s == 0; }
+    bool isAccept(State s) const { return m_accept[s >> m_shift] != 0; }
+    // 0 is the dead state; source state q is q + 1
+    uint32_t stateIndex(State s) const { return s >> m_shift; }
+    uint32_t numStates() const { return uint32_t(m_accept.size()); }
+    // Padded columns per row
+    uint32_t rowWidth() const { return uint32_t(1) << m_shift; }
+
+    State step(State s, unsigned char byte) const { return m_table[s + m_byteClass[byte]]; }
+    // symbol is an index into the source alphabet; out of range goes to dead
+    State stepSymbol(State s, uint32_t symbol) const {
+        return symbol < m_symbolClass.size() ? m_table[s + m_symbolClass[symbol]] : 0;
+    }
+
+    // Streaming: feed chunks in order, carrying the returned state across calls
+    State run(State s, const char* data, size_t size) const;
+    State run(State s, std::string_view input) const { return run(s, input.data(), input.size()); }
+
+    bool accepts(std::string_view input) const { return isAccept(run(m_start, input)); }
+    bool acceptsSymbols(const uint32_t* symbols, size_t size) const;
+
+    // results[i] = 1 when inputs[i] is accepted
+    void acceptsAll(const std::string_view* inputs, size_t count, uint8_t* results) const;
+    std::vector<uint8_t> acceptsAll(const std::vector<std::string_view>& inputs) const;
+    // One result per '\n'-terminated line of text (a trailing partial line counts);
+    // the newline itself is not fed to the automaton
+    size_t acceptsLines(std::string_view text, std::vector<uint8_t>& results) const;
+
+    // Bit i % 64 of bitmap[i / 64] is set when inputs[i] is accepted. A single
+    // walk waits on every table load in turn; the multi-stream kernels advance
+    // 16 strings together so those loads overlap.
+    void acceptsBitmap(const std::string_view* inputs, size_t count, uint64_t* bitmap,
+                       MatchKernel kernel = MatchKernel::Auto) const;
+    std::vector<uint64_t> acceptsBitmap(const std::vector<std::string_view>& inputs,
+                                        MatchKernel kernel = MatchKernel::Auto) const;
+
+    // Checked at run time; unsupported kernels fall back to Interleaved
+    static bool supported(MatchKernel kernel);
+    static const char* name(MatchKernel kernel);
+
+private:
+    template <class T>
+    struct CacheAligned {
+        using value_type = T;
+        CacheAligned() = default;
+        template <class U> CacheAligned(const CacheAligned<U>&) {}
+        T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(64))); }
+        void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(64)); }
+        template <class U> bool operator==(const CacheAligned<U>&) const { return true; }
+        template <class U> bool operator!=(const CacheAligned<U>&) const { return false; }
+    };
+
+    std::vector<State, CacheAligned<State>> m_table{0}; // dead row only
+    std::vector<uint8_t> m_accept{0};
+    std::array<uint32_t, 256> m_byteClass{};             // column 0: no symbol, or one without transitions
+    std::vector<uint32_t> m_symbolClass;                 // symbol a -> column of its alphabet class
+    uint32_t m_shift = 0;
+    State m_start = 0;
+};
\ No newline at end of file
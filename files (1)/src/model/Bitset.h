@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Fixed-size bit vector backed by 64-bit words.
+class Bitset {
+public:
+    Bitset() = default;
+    explicit Bitset(size_t n) { resize(n); }
+
+    void resize(size_t n) {
+        m_size = n;
+        m_words.resize((n + 63) / 64, 0);
+        // Keep bits past the end zero so count() and words() stay exact
+        if (n % 64 && !m_words.empty()) m_words.back() &= (uint64_t(1) << (n % 64)) - 1;
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    bool test(size_t i) const { return (m_words[i >> 6] >> (i & 63)) & 1; }
+    void set(size_t i) { m_words[i >> 6] |= uint64_t(1) << (i & 63); }
+    void reset(size_t i) { m_words[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+    void assign(size_t i, bool v) { if (v) set(i); else reset(i); }
+
+    // Tests bit i and sets it; returns the previous value
+    bool testAndSet(size_t i) {
+        uint64_t mask = uint64_t(1) << (i & 63);
+        bool was = (m_words[i >> 6] & mask) != 0;
+        m_words[i >> 6] |= mask;
+        return was;
+    }
+
+    void clearAll() { for (auto& w : m_words) w = 0; }
+
+    size_t count() const {
+        size_t n = 0;
+        for (uint64_t w : m_words) n += popcount(w);
+        return n;
+    }
+
+    // Index of the first set bit at or after `from`, or size() if there is none
+    size_t findNext(size_t from) const {
+        if (from >= m_size) return m_size;
+        size_t wi = from >> 6;
+        uint64_t w = m_words[wi] & (~uint64_t(0) << (from & 63));
+        while (true) {
+            if (w) {
+                size_t i = (wi << 6) + ctz(w);
+                return i < m_size ? i : m_size;
+            }
+            if (++wi >= m_words.size()) return m_size;
+            w = m_words[wi];
+        }
+    }
+
+    bool operator==(const Bitset& o) const { return m_size == o.m_size && m_words == o.m_words; }
+    bool operator!=(const Bitset& o) const { return !(*this == o); }
+
+    const std::vector<uint64_t>& words() const { return m_words; }
+    std::vector<uint64_t>& words() { return m_words; }
+
+    static int popcount(uint64_t w) {
+        w = w - ((w >> 1) & 0x5555555555555555ULL);
+        w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+        w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return int((w * 0x0101010101010101ULL) >> 56);
+    }
+
+    static int ctz(uint64_t w) {
+        // w must be non-zero
+        return popcount((w & (~w + 1)) - 1);
+    }
+
+private:
+    std::vector<uint64_t> m_words;
+    size_t m_size = 0;
+};
\ No newline at end of file
@@ -0,0 +1,296 @@
+#include "CompactDFA.h"
+#include <algorithm>
+
+uint32_t CompactDFA::addSymbol(const std::string& symbol) {
+    auto it = m_symbolIndex.find(symbol);
+    if (it != m_symbolIndex.end()) return it->second;
+
+    uint32_t a = numSymbols();
+    size_t oldWidth = m_symbols.size();
+    m_symbols.push_back(symbol);
+    m_symbolIndex.emplace(symbol, a);
+
+    // Widen existing rows; cheap when the alphabet is declared before the states
+    if (!m_stateIds.empty()) {
+        std::vector<uint32_t> widened(m_stateIds.size() * m_symbols.size(), NONE);
+        for (size_t q = 0; q < m_stateIds.size(); ++q) {
+            for (size_t c = 0; c < oldWidth; ++c) {
+                widened[q * m_symbols.size() + c] = m_delta[q * oldWidth + c];
+            }
+        }
+        m_delta.swap(widened);
+    }
+    return a;
+}
+
+uint32_t CompactDFA::addState(const std::string& id, bool start, bool accept, double x, double y) {
+    uint32_t q = numStates();
+    m_stateIds.push_back(id);
+    m_stateIndex.emplace(id, q); // keeps the first index on duplicates
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_delta.resize(m_delta.size() + m_symbols.size(), NONE);
+    m_accept.resize(q + 1);
+    m_start.resize(q + 1);
+    m_accept.assign(q, accept);
+    m_start.assign(q, start);
+    return q;
+}
+
+void CompactDFA::reserve(uint32_t states, uint32_t symbols) {
+    m_stateIds.reserve(states);
+    m_x.reserve(states);
+    m_y.reserve(states);
+    m_delta.reserve(size_t(states) * symbols);
+    m_stateIndex.reserve(states);
+    m_symbols.reserve(symbols);
+    m_symbolIndex.reserve(symbols);
+}
+
+void CompactDFA::clear() {
+    m_stateIds.clear();
+    m_symbols.clear();
+    m_delta.clear();
+    m_accept = Bitset();
+    m_start = Bitset();
+    m_x.clear();
+    m_y.clear();
+    m_foreign.clear();
+    m_rawAlphabet.clear();
+    m_stateIndex.clear();
+    m_symbolIndex.clear();
+}
+
+uint32_t CompactDFA::startState() const {
+    size_t q = m_start.findNext(0);
+    return q < m_start.size() ? uint32_t(q) : NONE;
+}
+
+size_t CompactDFA::transitionCount() const {
+    size_t n = 0;
+    for (uint32_t t : m_delta) {
+        if (t != NONE) ++n;
+    }
+    return n;
+}
+
+uint32_t CompactDFA::stateIndex(const std::string& id) const {
+    auto it = m_stateIndex.find(id);
+    return it != m_stateIndex.end() ? it->second : NONE;
+}
+
+uint32_t CompactDFA::symbolIndex(const std::string& symbol) const {
+    auto it = m_symbolIndex.find(symbol);
+    return it != m_symbolIndex.end() ? it->second : NONE;
+}
+
+Bitset CompactDFA::reachable() const {
+    Bitset seen;
+    std::vector<uint32_t> frontier;
+    reachable(seen, frontier);
+    return seen;
+}
+
+void CompactDFA::reachable(Bitset& seen, std::vector<uint32_t>& frontier) const {
+    const uint32_t n = numStates();
+    const uint32_t k = numSymbols();
+    seen.resize(n);
+    seen.clearAll();
+    frontier.clear();
+    uint32_t start = startState();
+    if (start == NONE) return;
+
+    // Every state enters the frontier once, so one array is the whole queue
+    frontier.reserve(n);
+    seen.set(start);
+    frontier.push_back(start);
+    for (size_t head = 0; head < frontier.size(); ++head) {
+        const uint32_t* r = row(frontier[head]);
+        for (uint32_t a = 0; a < k; ++a) {
+            if (r[a] != NONE && !seen.testAndSet(r[a])) frontier.push_back(r[a]);
+        }
+    }
+}
+
+Bitset CompactDFA::coReachable() const {
+    return canReach(m_accept);
+}
+
+Bitset CompactDFA::canReach(const Bitset& targets) const {
+    const uint32_t n = numStates();
+    const uint32_t k = numSymbols();
+
+    // Predecessor lists, counting-sorted by target
+    std::vector<uint32_t> predStart(size_t(n) + 1, 0);
+    for (uint32_t t : m_delta) {
+        if (t != NONE) ++predStart[t + 1];
+    }
+    for (uint32_t q = 0; q < n; ++q) predStart[q + 1] += predStart[q];
+    std::vector<uint32_t> pred(predStart[n]);
+    {
+        std::vector<uint32_t> fill(predStart.begin(), predStart.end() - 1);
+        for (uint32_t q = 0; q < n; ++q) {
+            const uint32_t* r = row(q);
+            for (uint32_t a = 0; a < k; ++a) {
+                if (r[a] != NONE) pred[fill[r[a]]++] = q;
+            }
+        }
+    }
+
+    // Backwards from every target at once
+    Bitset seen = targets;
+    std::vector<uint32_t> frontier;
+    frontier.reserve(n);
+    for (size_t q = seen.findNext(0); q < n; q = seen.findNext(q + 1)) frontier.push_back(uint32_t(q));
+    for (size_t head = 0; head < frontier.size(); ++head) {
+        uint32_t q = frontier[head];
+        for (uint32_t i = predStart[q]; i < predStart[q + 1]; ++i) {
+            if (!seen.testAndSet(pred[i])) frontier.push_back(pred[i]);
+        }
+    }
+    return seen;
+}
+
+Bitset CompactDFA::useful() const {
+    Bitset both = reachable();
+    Bitset co = coReachable();
+    for (size_t w = 0; w < both.words().size(); ++w) both.words()[w] &= co.words()[w];
+    return both;
+}
+
+std::vector<uint32_t> CompactDFA::compact(const Bitset& keep) {
+    const uint32_t n = numStates();
+    const size_t k = m_symbols.size();
+    std::vector<uint32_t> newIndex(n, NONE);
+    uint32_t count = 0;
+    for (size_t q = keep.findNext(0); q < n; q = keep.findNext(q + 1)) newIndex[q] = count++;
+
+    // Foreign transitions from or to a dropped state go with it
+    if (!m_foreign.empty()) {
+        auto dropped = [&](const std::string& id) {
+            uint32_t q = stateIndex(id);
+            return q != NONE && newIndex[q] == NONE;
+        };
+        m_foreign.erase(std::remove_if(m_foreign.begin(), m_foreign.end(),
+                                       [&](const DFATransition& t) { return dropped(t.from) || dropped(t.to); }),
+                        m_foreign.end());
+    }
+
+    // Survivors only move down, so a single forward pass can shift them in place
+    for (uint32_t q = 0; q < n; ++q) {
+        uint32_t p = newIndex[q];
+        if (p == NONE) continue;
+        const uint32_t* src = m_delta.data() + q * k;
+        uint32_t* dst = m_delta.data() + p * k;
+        for (size_t a = 0; a < k; ++a) dst[a] = src[a] == NONE ? NONE : newIndex[src[a]];
+        if (p == q) continue;
+        m_stateIds[p] = std::move(m_stateIds[q]);
+        m_x[p] = m_x[q];
+        m_y[p] = m_y[q];
+        m_accept.assign(p, m_accept.test(q));
+        m_start.assign(p, m_start.test(q));
+    }
+    m_delta.resize(count * k);
+    m_stateIds.resize(count);
+    m_x.resize(count);
+    m_y.resize(count);
+    m_accept.resize(count);
+    m_start.resize(count);
+
+    m_stateIndex.clear();
+    m_stateIndex.reserve(count);
+    for (uint32_t p = 0; p < count; ++p) m_stateIndex.emplace(m_stateIds[p], p);
+    return newIndex;
+}
+
+CompactDFA CompactDFA::subset(const Bitset& keep) const {
+    // Copy the flat tables and compact the copy; the id index is built once, for the survivors
+    CompactDFA out;
+    out.m_stateIds = m_stateIds;
+    out.m_symbols = m_symbols;
+    out.m_delta = m_delta;
+    out.m_accept = m_accept;
+    out.m_start = m_start;
+    out.m_x = m_x;
+    out.m_y = m_y;
+    out.m_symbolIndex = m_symbolIndex;
+    out.compact(keep);
+    return out;
+}
+
+CompactDFA CompactDFA::reachablePart() const {
+    return subset(reachable());
+}
+
+CompactDFA CompactDFA::trimmed() const {
+    uint32_t start = startState();
+    if (start == NONE) return subset(Bitset(numStates()));
+    Bitset keep = useful();
+    bool startUseful = keep.test(start);
+    keep.set(start);
+    CompactDFA out = subset(keep);
+    if (!startUseful) {
+        // Everything it leads to was dropped except, perhaps, itself
+        uint32_t q = out.startState();
+        for (uint32_t a = 0; a < out.numSymbols(); ++a) out.setTransition(q, a, NONE);
+    }
+    return out;
+}
+
+CompactDFA CompactDFA::fromDFA(const DFA& dfa) {
+    CompactDFA c;
+    c.reserve(uint32_t(dfa.states.size()), uint32_t(dfa.alphabet.size()));
+
+    for (const auto& sym : dfa.alphabet) c.addSymbol(sym);
+    // A repeated alphabet entry interns once; remember the raw list only if it differs
+    if (c.numSymbols() != dfa.alphabet.size()) c.m_rawAlphabet = dfa.alphabet;
+
+    // Bypass addState so the table is allocated once
+    uint32_t n = uint32_t(dfa.states.size());
+    c.m_delta.assign(size_t(n) * c.numSymbols(), NONE);
+    c.m_accept.resize(n);
+    c.m_start.resize(n);
+    for (uint32_t q = 0; q < n; ++q) {
+        const DFAState& s = dfa.states[q];
+        c.m_stateIds.push_back(s.id);
+        c.m_stateIndex.emplace(s.id, q);
+        c.m_x.push_back(s.x);
+        c.m_y.push_back(s.y);
+        c.m_accept.assign(q, s.isAccept);
+        c.m_start.assign(q, s.isStart);
+    }
+
+    for (const auto& kv : dfa.transitions) {
+        uint32_t from = c.stateIndex(kv.first.first);
+        uint32_t a = c.symbolIndex(kv.first.second);
+        uint32_t to = c.stateIndex(kv.second);
+        if (from == NONE || a == NONE || to == NONE) {
+            c.m_foreign.push_back({kv.first.first, kv.first.second, kv.second});
+            continue;
+        }
+        c.setTransition(from, a, to);
+    }
+    return c;
+}
+
+DFA CompactDFA::toDFA() const {
+    DFA dfa;
+    dfa.alphabet = m_rawAlphabet.empty() ? m_symbols : m_rawAlphabet;
+
+    // Push states directly: addState would clear earlier start flags
+    dfa.states.reserve(m_stateIds.size());
+    for (uint32_t q = 0; q < numStates(); ++q) {
+        dfa.states.push_back({m_stateIds[q], m_start.test(q), m_accept.test(q), m_x[q], m_y[q]});
+    }
+
+    for (uint32_t q = 0; q < numStates(); ++q) {
+        // Only the first state with a given id owns transitions, as in fromDFA
+        if (m_stateIndex.at(m_stateIds[q]) != q) continue;
+        const uint32_t* r = row(q);
+        for (uint32_t a = 0; a < numSymbols(); ++a) {
+            if (r[a] != NONE) dfa.addTransition(m_stateIds[q], m_symbols[a], m_stateIds[r[a]]);
+        }
+    }
+    for (const auto& t : m_foreign) dfa.addTransition(t.from, t.symbol, t.to);
+    return dfa;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "DFA.h"
+#include "Bitset.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Integer-indexed form of DFA used by the algorithms.
+// State ids and alphabet symbols are interned to dense uint32_t indices (in the
+// order they appear in the source DFA) and transitions live in one row-major
+// table: delta[state * numSymbols() + symbol], NONE where no transition exists.
+class CompactDFA {
+public:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    // Construction
+    uint32_t addSymbol(const std::string& symbol);
+    uint32_t addState(const std::string& id, bool start, bool accept, double x = 0.0, double y = 0.0);
+    void setTransition(uint32_t from, uint32_t symbol, uint32_t to) { m_delta[size_t(from) * m_symbols.size() + symbol] = to; }
+    void setAccept(uint32_t q, bool accept) { m_accept.assign(q, accept); }
+    void setStart(uint32_t q, bool start) { m_start.assign(q, start); }
+    void setPosition(uint32_t q, double x, double y) { m_x[q] = x; m_y[q] = y; }
+    void addForeignTransition(const DFATransition& t) { m_foreign.push_back(t); }
+    void reserve(uint32_t states, uint32_t symbols);
+    void clear();
+
+    // Queries
+    uint32_t numStates() const { return uint32_t(m_stateIds.size()); }
+    uint32_t numSymbols() const { return uint32_t(m_symbols.size()); }
+    uint32_t next(uint32_t q, uint32_t a) const { return m_delta[size_t(q) * m_symbols.size() + a]; }
+    const uint32_t* row(uint32_t q) const { return m_delta.data() + size_t(q) * m_symbols.size(); }
+    const std::vector<uint32_t>& table() const { return m_delta; }
+    bool isAccept(uint32_t q) const { return m_accept.test(q); }
+    bool isStart(uint32_t q) const { return m_start.test(q); }
+    const Bitset& acceptSet() const { return m_accept; }
+    const Bitset& startSet() const { return m_start; }
+    uint32_t startState() const; // first start state, or NONE
+    size_t transitionCount() const;
+
+    const std::string& stateId(uint32_t q) const { return m_stateIds[q]; }
+    const std::string& symbol(uint32_t a) const { return m_symbols[a]; }
+    const std::vector<std::string>& symbols() const { return m_symbols; }
+    double x(uint32_t q) const { return m_x[q]; }
+    double y(uint32_t q) const { return m_y[q]; }
+    uint32_t stateIndex(const std::string& id) const;
+    uint32_t symbolIndex(const std::string& symbol) const;
+
+    // Transitions that name an undeclared state or a symbol outside the alphabet.
+    // The algorithms ignore them; they are only carried so toDFA() is lossless.
+    const std::vector<DFATransition>& foreignTransitions() const { return m_foreign; }
+
+    // Bit q set when q is reachable from startState(). One pass over the
+    // table with a flat frontier; no other start state counts.
+    Bitset reachable() const;
+    // Same, into caller-owned buffers; allocates nothing once they hold numStates()
+    void reachable(Bitset& seen, std::vector<uint32_t>& frontier) const;
+    // Bit q set when some accept state is reachable from q
+    Bitset coReachable() const;
+    // Bit q set when some state in targets (sized numStates()) is reachable from q
+    Bitset canReach(const Bitset& targets) const;
+    // Reachable and co-reachable: the states on some accepting path
+    Bitset useful() const;
+
+    // Drops the states not in keep, in place, and renumbers the rest in their
+    // old order; transitions into dropped states become NONE. Returns the old
+    // -> new index map, NONE for dropped states.
+    std::vector<uint32_t> compact(const Bitset& keep);
+
+    // Copy without the states unreachable from startState(); state order is kept
+    CompactDFA reachablePart() const;
+    // Copy with only the useful states plus the start state, which keeps no
+    // transitions of its own when it is not useful
+    CompactDFA trimmed() const;
+
+    // Conversion
+    static CompactDFA fromDFA(const DFA& dfa);
+    DFA toDFA() const;
+
+private:
+    friend class MappedDFA; // bulk-loads the tables from a mapped file
+
+    // Copy of the tables for the states in keep, renumbered; no foreign transitions
+    CompactDFA subset(const Bitset& keep) const;
+
+    std::vector<std::string> m_stateIds;
+    std::vector<std::string> m_symbols;
+    std::vector<uint32_t> m_delta;
+    Bitset m_accept;
+    Bitset m_start;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<DFATransition> m_foreign;
+    // Source alphabet, kept only when it lists a symbol more than once
+    std::vector<std::string> m_rawAlphabet;
+    // First index of each name; duplicate state ids resolve to the first one like DFA::getState
+    std::unordered_map<std::string, uint32_t> m_stateIndex;
+    std::unordered_map<std::string, uint32_t> m_symbolIndex;
+};
\ No newline at end of file
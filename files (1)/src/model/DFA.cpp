@@ -1,6 +1,7 @@
 #include "DFA.h"
-#include <queue>
+#include "CompactDFA.h"
 #include <algorithm>
+#include <unordered_map>
 
 void DFA::addState(const std::string& id, bool start, bool accept, double x, double y) {
     // If start is true, unset others
@@ -11,7 +12,10 @@ void DFA::addState(const std::string& id, bool start, bool accept, double x, dou
 }
 
 void DFA::addTransition(const std::string& from, const std::string& symbol, const std::string& to) {
-    transitions[{from, symbol}] = to;
+    auto it = transitions.emplace(std::make_pair(from, symbol), to).first;
+    if (it->second == to) return;
+    conflicts.push_back({from, symbol, it->second});
+    it->second = to;
 }
 
 DFAState* DFA::getState(const std::string& id) {
@@ -28,15 +32,6 @@ const DFAState* DFA::getState(const std::string& id) const {
     return nullptr;
 }
 
-bool DFA::isDeterministic() const {
-    // In this model, using a map automatically prevents duplicate (state, symbol) keys.
-    // However, we must ensure every state has exactly one transition for every symbol
-    // to be "fully" deterministic in some definitions, but usually valid input
-    // just requires <= 1. If map logic enforces 1, we check if we have all symbols.
-    // Here we define deterministic as: No ambiguity. Map structure enforces this naturally.
-    return true; 
-}
-
 std::vector<std::pair<std::string, std::string>> DFA::getMissingTransitions() const {
     std::vector<std::pair<std::string, std::string>> missing;
     for (const auto& s : states) {
@@ -51,58 +46,57 @@ std::vector<std::pair<std::string, std::string>> DFA::getMissingTransitions() co
 
 std::set<std::string> DFA::getReachableStates() const {
     std::set<std::string> reachable;
-    std::queue<std::string> q;
-    
-    std::string startId;
-    for (const auto& s : states) {
-        if (s.isStart) {
-            startId = s.id;
-            break;
-        }
-    }
-    
-    if (startId.empty()) return reachable;
-    
-    reachable.insert(startId);
-    q.push(startId);
-    
-    while (!q.empty()) {
-        std::string curr = q.front();
-        q.pop();
-        
-        for (const auto& sym : alphabet) {
-            if (transitions.count({curr, sym})) {
-                std::string next = transitions.at({curr, sym});
-                if (reachable.find(next) == reachable.end()) {
-                    reachable.insert(next);
-                    q.push(next);
-                }
-            }
-        }
-    }
+    Bitset mask = reachableStates();
+    for (size_t i = mask.findNext(0); i < states.size(); i = mask.findNext(i + 1)) reachable.insert(states[i].id);
     return reachable;
 }
 
-void DFA::removeUnreachable() {
-    std::set<std::string> reachable = getReachableStates();
-    std::vector<DFAState> newStates;
-    for (const auto& s : states) {
-        if (reachable.count(s.id)) {
-            newStates.push_back(s);
-        }
+Bitset DFA::reachableStates() const {
+    return CompactDFA::fromDFA(*this).reachable();
+}
+
+Bitset DFA::coReachableStates() const {
+    return CompactDFA::fromDFA(*this).coReachable();
+}
+
+void DFA::keepStates(const Bitset& keep) {
+    // Transitions name states by id; a repeated id means its first state, like getState
+    std::unordered_map<std::string, bool> kept;
+    kept.reserve(states.size());
+    for (size_t i = 0; i < states.size(); ++i) kept.emplace(states[i].id, keep.test(i));
+    auto dropped = [&](const std::string& id) {
+        auto it = kept.find(id);
+        return it != kept.end() && !it->second;
+    };
+
+    // Shift survivors down in place
+    size_t count = 0;
+    for (size_t i = 0; i < states.size(); ++i) {
+        if (!keep.test(i)) continue;
+        if (count != i) states[count] = std::move(states[i]);
+        ++count;
     }
-    states = newStates;
-    
-    // Clean transitions
-    auto it = transitions.begin();
-    while (it != transitions.end()) {
-        if (reachable.find(it->first.first) == reachable.end() ||
-            reachable.find(it->second) == reachable.end()) {
-            it = transitions.erase(it);
-        } else {
-            ++it;
-        }
+    states.resize(count);
+
+    for (auto it = transitions.begin(); it != transitions.end();) {
+        if (dropped(it->first.first) || dropped(it->second)) it = transitions.erase(it);
+        else ++it;
     }
+    conflicts.erase(std::remove_if(conflicts.begin(), conflicts.end(),
+                                   [&](const DFATransition& t) { return dropped(t.from) || dropped(t.to); }),
+                    conflicts.end());
+}
+
+void DFA::removeUnreachable() {
+    keepStates(reachableStates());
+}
+
+void DFA::trim() {
+    CompactDFA compact = CompactDFA::fromDFA(*this);
+    Bitset keep = compact.useful();
+    uint32_t start = compact.startState();
+    if (start != CompactDFA::NONE) keep.set(start);
+    keepStates(keep);
 }
 
 void DFA::completeWithSink() {
@@ -116,7 +110,14 @@ void DFA::completeWithSink() {
         sinkName = "sink" + std::to_string(++i);
     }
     
-    addState(sinkName, false, false, 0, 0); // Position at 0,0, user can move
+    // Right of everything else, level with the middle, so it overlaps nothing
+    double sinkX = 0, minY = 0, maxY = 0;
+    for (size_t k = 0; k < states.size(); ++k) {
+        if (k == 0 || states[k].x + 150 > sinkX) sinkX = states[k].x + 150;
+        if (k == 0 || states[k].y < minY) minY = states[k].y;
+        if (k == 0 || states[k].y > maxY) maxY = states[k].y;
+    }
+    addState(sinkName, false, false, sinkX, (minY + maxY) / 2);
     
     // Add transitions to sink
     for (const auto& m : missing) {
@@ -132,5 +133,6 @@ void DFA::completeWithSink() {
 void DFA::clear() {
     states.clear();
     transitions.clear();
+    conflicts.clear();
     alphabet.clear();
 }
\ No newline at end of file
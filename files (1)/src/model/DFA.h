@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Bitset.h"
 #include <string>
 #include <vector>
 #include <map>
@@ -27,16 +28,24 @@ public:
     std::vector<DFAState> states;
     // Map: pair(from_id, symbol) -> to_id
     std::map<std::pair<std::string, std::string>, std::string> transitions;
+    // Transitions displaced by a later one for the same (from, symbol) with a
+    // different target; non-empty means the input was nondeterministic
+    std::vector<DFATransition> conflicts;
 
     void addState(const std::string& id, bool start, bool accept, double x, double y);
+    // The last target for a (from, symbol) wins; an earlier different one moves to conflicts
     void addTransition(const std::string& from, const std::string& symbol, const std::string& to);
     
     // Validation
-    bool isDeterministic() const;
+    bool isDeterministic() const { return conflicts.empty(); }
     std::vector<std::pair<std::string, std::string>> getMissingTransitions() const;
     
     // Manipulation
     void removeUnreachable();
+    // Removes every state that is unreachable or cannot reach an accept state; the start state stays
+    void trim();
+    // Keeps the states whose bit is set (in order) and drops the transitions touching the others
+    void keepStates(const Bitset& keep);
     void completeWithSink();
     
     DFAState* getState(const std::string& id);
@@ -44,5 +53,8 @@ public:
     
     // Helpers
     std::set<std::string> getReachableStates() const;
+    // Bit i refers to states[i]; both run over the integer transition table
+    Bitset reachableStates() const;
+    Bitset coReachableStates() const; // states that can reach an accept state
     void clear();
 };
\ No newline at end of file
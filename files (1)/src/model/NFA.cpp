@@ -0,0 +1,83 @@
+#include "NFA.h"
+
+uint32_t NFA::addSymbol(const std::string& symbol) {
+    auto it = m_symbolIndex.emplace(symbol, numSymbols()).first;
+    if (it->second == numSymbols()) m_symbols.push_back(symbol);
+    return it->second;
+}
+
+uint32_t NFA::addState(const std::string& id, bool start, bool accept, double x, double y) {
+    uint32_t q = numStates();
+    m_stateIds.push_back(id);
+    m_stateIndex.emplace(id, q);
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_accept.resize(q + 1);
+    m_start.resize(q + 1);
+    m_accept.assign(q, accept);
+    m_start.assign(q, start);
+    return q;
+}
+
+bool NFA::addTransition(const std::string& from, const std::string& symbol, const std::string& to) {
+    uint32_t p = stateIndex(from), q = stateIndex(to);
+    uint32_t a = isEpsilon(symbol) ? Epsilon : symbolIndex(symbol);
+    if (p == NONE || q == NONE || (a == NONE && !isEpsilon(symbol))) return false;
+    addTransition(p, a, q);
+    return true;
+}
+
+void NFA::clear() {
+    m_stateIds.clear();
+    m_symbols.clear();
+    m_edges.clear();
+    m_accept = Bitset();
+    m_start = Bitset();
+    m_x.clear();
+    m_y.clear();
+    m_stateIndex.clear();
+    m_symbolIndex.clear();
+}
+
+bool NFA::hasEpsilon() const {
+    for (const Edge& e : m_edges) {
+        if (e.symbol == Epsilon) return true;
+    }
+    return false;
+}
+
+uint32_t NFA::stateIndex(const std::string& id) const {
+    auto it = m_stateIndex.find(id);
+    return it != m_stateIndex.end() ? it->second : NONE;
+}
+
+uint32_t NFA::symbolIndex(const std::string& symbol) const {
+    auto it = m_symbolIndex.find(symbol);
+    return it != m_symbolIndex.end() ? it->second : NONE;
+}
+
+bool NFA::isEpsilon(const std::string& symbol) {
+    return symbol.empty() || symbol == "ε";
+}
+
+NFA NFA::fromDFA(const DFA& dfa) {
+    NFA nfa;
+    for (const auto& sym : dfa.alphabet) {
+        // ε in the alphabet still means ε
+        if (!isEpsilon(sym)) nfa.addSymbol(sym);
+    }
+    for (const auto& s : dfa.states) nfa.addState(s.id, s.isStart, s.isAccept, s.x, s.y);
+    for (const auto& kv : dfa.transitions) nfa.addTransition(kv.first.first, kv.first.second, kv.second);
+    for (const auto& t : dfa.conflicts) nfa.addTransition(t.from, t.symbol, t.to);
+    return nfa;
+}
+
+DFA NFA::toDFA() const {
+    DFA dfa;
+    dfa.alphabet = m_symbols;
+    for (uint32_t q = 0; q < numStates(); ++q) dfa.addState(m_stateIds[q], isStart(q), isAccept(q), m_x[q], m_y[q]);
+    for (const Edge& e : m_edges) {
+        dfa.addTransition(m_stateIds[e.from], e.symbol == Epsilon ? "ε" : m_symbols[e.symbol], m_stateIds[e.to]);
+    }
+    return dfa;
+}
\ No newline at end of file
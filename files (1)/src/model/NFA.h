@@ -0,0 +1,70 @@
+#pragma once
+
+#include "DFA.h"
+#include "Bitset.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Nondeterministic automaton with ε-transitions, interned like CompactDFA:
+// states and symbols are dense uint32_t indices, transitions a flat edge list
+// (any number per state and symbol) and any number of states may be start
+// states. SubsetConstruction turns it into a CompactDFA.
+class NFA {
+public:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+    static constexpr uint32_t Epsilon = NONE; // symbol of an ε-transition
+
+    struct Edge {
+        uint32_t from, symbol, to;
+    };
+
+    // Construction
+    uint32_t addSymbol(const std::string& symbol);
+    uint32_t addState(const std::string& id, bool start, bool accept, double x = 0.0, double y = 0.0);
+    void addTransition(uint32_t from, uint32_t symbol, uint32_t to) { m_edges.push_back({from, symbol, to}); }
+    // By name: ε names give ε-edges; unknown states and symbols outside the
+    // alphabet are ignored, as the algorithms ignore foreign DFA transitions.
+    // Returns false when the transition was ignored.
+    bool addTransition(const std::string& from, const std::string& symbol, const std::string& to);
+    void setAccept(uint32_t q, bool accept) { m_accept.assign(q, accept); }
+    void setStart(uint32_t q, bool start) { m_start.assign(q, start); }
+    void clear();
+
+    // Queries
+    uint32_t numStates() const { return uint32_t(m_stateIds.size()); }
+    uint32_t numSymbols() const { return uint32_t(m_symbols.size()); }
+    const std::vector<Edge>& edges() const { return m_edges; }
+    bool hasEpsilon() const;
+    bool isAccept(uint32_t q) const { return m_accept.test(q); }
+    bool isStart(uint32_t q) const { return m_start.test(q); }
+    const std::string& stateId(uint32_t q) const { return m_stateIds[q]; }
+    const std::string& symbol(uint32_t a) const { return m_symbols[a]; }
+    const std::vector<std::string>& symbols() const { return m_symbols; }
+    double x(uint32_t q) const { return m_x[q]; }
+    double y(uint32_t q) const { return m_y[q]; }
+    uint32_t stateIndex(const std::string& id) const;
+    uint32_t symbolIndex(const std::string& symbol) const;
+
+    // Symbol names that mean ε in files and in the editor: "" and "ε"
+    static bool isEpsilon(const std::string& symbol);
+
+    // Every transition of dfa, the displaced ones in DFA::conflicts included
+    static NFA fromDFA(const DFA& dfa);
+    // Back by name, ε-edges on "ε"; exact only when SubsetConstruction::needed
+    // is false (DFA keeps one start state and one target per state and symbol)
+    DFA toDFA() const;
+
+private:
+    std::vector<std::string> m_stateIds;
+    std::vector<std::string> m_symbols;
+    std::vector<Edge> m_edges;
+    Bitset m_accept;
+    Bitset m_start;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    // First index of each name, as in CompactDFA
+    std::unordered_map<std::string, uint32_t> m_stateIndex;
+    std::unordered_map<std::string, uint32_t> m_symbolIndex;
+};
\ No newline at end of file